@@ -38,16 +38,21 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <deque>
+#include <list>
 
 // Algorithms and utilities
 #include <algorithm>
 #include <stdexcept>
 #include <limits>
+#include <new>
 
 // C-style libraries
 #include <cstring>
+#include <strings.h>
 #include <cstdlib>
 #include <cctype>
+#include <ctime>
 
 // ==================== LIBRERIE SISTEMA UNIX/LINUX ====================
 
@@ -55,6 +60,23 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+
+// Piattaforme senza MSG_NOSIGNAL (macOS): SIGPIPE viene ignorato in main()
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+#ifndef MSG_MORE
+# define MSG_MORE 0
+#endif
+
+// Zero-copy file -> socket
+#ifdef __linux__
+# include <sys/sendfile.h>
+#endif
 
 // File operations
 #include <unistd.h>
@@ -64,9 +86,15 @@
 
 // Process management
 #include <sys/wait.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sched.h>
 
 // I/O Multiplexing
 #include <poll.h>
+#ifdef __linux__
+# include <sys/epoll.h>
+#endif
 
 // Error handling
 #include <errno.h>
@@ -82,10 +110,12 @@
 // Core classes
 class Server;
 class Client;
+class EventLoop;
 
 // HTTP classes
 class Request;
 class Response;
+class DirectoryListing;
 
 // Configuration classes
 class ConfigParser;
@@ -94,6 +124,7 @@ class LocationConfig;
 
 // CGI classes
 class CGIExecutor;
+class CGIProcess;
 
 // Utility classes
 class FileHandler;
@@ -106,6 +137,8 @@ class MimeTypes;
 #define HTTP_OK 200
 #define HTTP_CREATED 201
 #define HTTP_NO_CONTENT 204
+#define HTTP_MOVED_PERMANENTLY 301
+#define HTTP_NOT_MODIFIED 304
 #define HTTP_BAD_REQUEST 400
 #define HTTP_FORBIDDEN 403
 #define HTTP_NOT_FOUND 404
@@ -113,6 +146,7 @@ class MimeTypes;
 #define HTTP_REQUEST_ENTITY_TOO_LARGE 413
 #define HTTP_INTERNAL_SERVER_ERROR 500
 #define HTTP_NOT_IMPLEMENTED 501
+#define HTTP_VERSION_NOT_SUPPORTED 505
 
 // Buffer sizes
 #define BUFFER_SIZE 1024
@@ -123,11 +157,20 @@ class MimeTypes;
 #define DEFAULT_MAX_BODY_SIZE 1048576  // 1MB
 #define DEFAULT_ROOT "./www"
 #define DEFAULT_INDEX "index.html"
+#define DEFAULT_PIPELINE_DEPTH 16
+#define DEFAULT_ACCEPT_BUDGET 64           // Connessioni accettate per evento del listener
+#define DEFAULT_KEEPALIVE_TIMEOUT 75000    // ms
+#define DEFAULT_CLIENT_TIMEOUT 60000       // ms: header, body e send timeout
+#define STREAM_BUFFER_LIMIT 262144  // Oltre questa coda verso il client si smette di produrre (CGI, autoindex)
+
+// CGI
+#define CGI_TIMEOUT_SECONDS 30
 
 // HTTP constants
 #define HTTP_VERSION "HTTP/1.1"
 #define HTTP_HEADER_SEPARATOR "\r\n\r\n"
 #define HTTP_LINE_SEPARATOR "\r\n"
+#define HTTP_LAST_CHUNK "0\r\n\r\n"
 
 // ==================== UTILITY FUNCTIONS ====================
 
@@ -6,13 +6,19 @@
 #include "../../HTTP/incs/Request.hpp"
 #include "../../Config/incs/LocationConfig.hpp"
 
+#include "CGIProcess.hpp"
+
 class CGIExecutor {
 public:
     CGIExecutor(const Request& request, const LocationConfig& location);
     ~CGIExecutor();
     void setupEnvironment();
+    std::map<std::string, std::string> buildEnvironment(const std::string& script_path) const;
+    std::string buildFastCGIRequest() const;
+    std::string buildWorkerRequest() const;
+    CGIWorkerSpec workerSpec() const;
     char** createExecArgs() const;
-    std::string execute();
+    void start(CGIProcess& process);
     std::string getScriptPath() const;
 
 private:
@@ -0,0 +1,126 @@
+/**
+ * @file CGIProcess.hpp
+ * @brief Stato di uno script CGI in esecuzione dentro il loop degli eventi
+ *
+ * Con fastcgi_pass lo stesso stato descrive una richiesta verso un
+ * backend FastCGI: stdout_fd è la connessione, input i record da
+ * inviare e pid resta -1. Con cgi_pool stdout_fd è il socket di un
+ * worker persistente (gestito da CGIWorkerPool) e pid resta -1.
+ *
+ * Le pipe stdin/stdout del figlio sono registrate nel loop come ogni
+ * altro descrittore: il body della richiesta viene scritto quando la
+ * pipe è scrivibile e l'output letto quando arriva, una operazione per
+ * evento. Nessuna attesa bloccante: il timeout è una scadenza controllata
+ * dal loop principale.
+ *
+ * L'output viene convertito in risposta HTTP man mano che arriva:
+ * l'header "Status" diventa la status line, "Location" senza Status
+ * diventa un 302. Gli header restano in attesa fino al primo byte di
+ * body, così uno script che si blocca dopo gli header riceve ancora
+ * un 504 pulito invece di una risposta troncata.
+ *
+ * Se lo script non indica Content-Length e non ha ancora finito, ai
+ * client HTTP/1.1 il body parte in Transfer-Encoding: chunked e la
+ * connessione resta riusabile; agli altri la fine del body è la
+ * chiusura della connessione.
+ *
+ * Per una HEAD partono solo status line e header (Content-Length solo
+ * se noto, mai chunked): il body dello script viene letto e scartato,
+ * altrimenti sulla connessione persistente diventerebbe l'inizio della
+ * risposta successiva.
+ */
+
+#ifndef CGIPROCESS_HPP
+#define CGIPROCESS_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "FastCGI.hpp"
+#include "CGIWorkerPool.hpp"
+
+class CGIProcess {
+public:
+    /** @brief Dimensione massima del blocco di header prodotto dallo script */
+    static const size_t MAX_HEADER_SIZE = 32768;
+
+    /** @brief Byte letti dalla pipe di output per evento */
+    static const size_t READ_CHUNK = 65536;
+
+    CGIProcess();
+
+    pid_t       pid;
+    int         client_fd;
+    unsigned    client_generation;  ///< Generazione dello slot del client (ClientTable)
+    int         stdin_fd;       ///< -1 quando il body è stato scritto tutto
+    int         stdout_fd;      ///< -1 dopo l'EOF
+    std::string input;          ///< Body della richiesta da passare allo script
+    size_t      input_offset;
+    time_t      deadline;
+    bool        paused;         ///< Lettura sospesa: coda del client troppo piena
+    bool        allow_chunked;  ///< Client HTTP/1.1: body di lunghezza ignota in chunked
+    bool        is_head;        ///< Richiesta HEAD: solo header, l'output dello script viene scartato
+
+    // ==================== FASTCGI ====================
+
+    std::string   backend;      ///< Indirizzo fastcgi_pass (vuoto per gli script forkati)
+    bool          reused;       ///< Connessione presa dal pool (può essere stata chiusa dal backend)
+    bool          reusable;     ///< END_REQUEST (o blocco finale del worker) ricevuto: connessione riusabile
+    FastCGIParser records;
+
+    // ==================== CGI_POOL ====================
+
+    CGIWorkerSpec  pool;        ///< Coppia interprete/script (disabilitato fuori da cgi_pool)
+    CGIFrameParser frames;
+
+    /**
+     * @brief Elabora un blocco di output dello script
+     * @param keep_alive Stato keep-alive del client, azzerato se la
+     *        risposta non ha Content-Length (fine body = chiusura)
+     * @return Byte da accodare al client (status line e header inclusi
+     *         al primo blocco di body)
+     */
+    std::string consume(const char* data, size_t length, bool& keep_alive);
+
+    /**
+     * @brief Accumula output senza produrre la risposta
+     *
+     * Per i byte che precedono di poco la fine (es. STDOUT ed END_REQUEST
+     * FastCGI nello stesso blocco): con finish() la lunghezza è nota e
+     * la connessione resta keep-alive.
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Chiude la risposta all'EOF dello script
+     * @return Byte ancora da accodare (vuoto se tutto è già partito)
+     */
+    std::string finish(bool& keep_alive);
+
+    /** @brief true se la status line è già stata accodata */
+    bool responseStarted() const { return _started; }
+
+    /** @brief true se lo script non ha prodotto alcun output */
+    bool producedNothing() const { return !_started && _buffer.empty() && _state == HEADERS; }
+
+private:
+    enum State { HEADERS, BODY };
+
+    State       _state;
+    std::string _buffer;        ///< Output in attesa (header incompleti o body prima dell'invio)
+    std::string _status;        ///< Es. "200 OK"
+    std::string _headers;       ///< Header dello script già in formato HTTP
+    bool        _has_length;
+    bool        _has_type;
+    bool        _has_date;      ///< Lo script ha già inviato Date
+    bool        _redirect;      ///< Location senza Status: 302
+    bool        _started;
+    bool        _chunked;       ///< Body inviato in Transfer-Encoding: chunked
+
+    bool scanHeaders();
+    void parseHeaders(const std::string& block);
+    void headersDone(size_t body_start);
+    std::string head(bool& keep_alive, bool at_eof);
+    std::string body();
+};
+
+#endif // CGIPROCESS_HPP
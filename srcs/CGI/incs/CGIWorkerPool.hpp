@@ -0,0 +1,121 @@
+/**
+ * @file CGIWorkerPool.hpp
+ * @brief Interpreti CGI pre-avviati e riusati tra più richieste
+ *
+ * Con "cgi_pool N" una location non fa più pipe + fork + execve per
+ * ogni richiesta: per ogni coppia (interprete, script) restano vivi
+ * fino a N processi, ognuno con stdin e stdout collegati allo stesso
+ * socket UNIX verso il server. Le richieste vengono assegnate una alla
+ * volta ai processi liberi; se sono tutti occupati la richiesta attende
+ * il primo che si libera. Un processo viene riciclato dopo
+ * cgi_pool_max_requests richieste, e sostituito se termina o va in crash.
+ *
+ * Framing (interi a 32 bit big-endian):
+ *   richiesta: [lunghezza][NOME=valore\0 ...] [lunghezza][body]
+ *   risposta:  [lunghezza][output CGI] ... [0]
+ *
+ * L'output ha lo stesso formato di uno script CGI classico (header,
+ * riga vuota, body). Lo script riceve WEBSERV_CGI_POOL=1 nell'ambiente
+ * all'avvio e deve uscire quando lo stdin arriva a EOF.
+ */
+
+#ifndef CGIWORKERPOOL_HPP
+#define CGIWORKERPOOL_HPP
+
+#include "../../../incs/webserv.hpp"
+
+namespace CGIFrame {
+    /** @brief Dimensione del prefisso di lunghezza */
+    const size_t HEADER_SIZE = 4;
+
+    /** @brief Serializza ambiente e body di una richiesta */
+    std::string encodeRequest(const std::map<std::string, std::string>& env, const std::string& body);
+}
+
+/**
+ * @brief Estrae i blocchi di output inviati da un worker
+ */
+class CGIFrameParser {
+public:
+    CGIFrameParser();
+
+    void feed(const char* data, size_t length);
+
+    /**
+     * @brief Estrae il prossimo blocco completo
+     * @param chunk Contenuto del blocco (vuoto = fine della risposta)
+     * @return false se servono altri byte
+     */
+    bool next(std::string& chunk);
+
+    /** @brief true se non restano byte non elaborati */
+    bool empty() const { return _offset == _buffer.size(); }
+
+private:
+    std::string _buffer;
+    size_t      _offset;
+};
+
+/**
+ * @brief Interprete e script di una location con cgi_pool
+ */
+struct CGIWorkerSpec {
+    std::string interpreter;
+    std::string script;         ///< Percorso dello script (relativo alla directory del server)
+    size_t      max_workers;
+    size_t      max_requests;
+
+    CGIWorkerSpec() : interpreter(), script(), max_workers(0), max_requests(0) {}
+
+    /** @brief false per le richieste non servite dal pool */
+    bool enabled() const { return max_workers > 0; }
+};
+
+class CGIWorkerPool {
+public:
+    CGIWorkerPool();
+    ~CGIWorkerPool();
+
+    /**
+     * @brief Assegna la richiesta a un worker libero, avviandone uno se serve
+     * @return Socket del worker, -1 se tutti i worker della coppia sono occupati
+     * @throws std::runtime_error se socketpair() o l'avvio falliscono
+     */
+    int acquire(const CGIWorkerSpec& spec);
+
+    /**
+     * @brief Richiesta conclusa: il worker torna libero
+     * @return false se ha raggiunto il limite di richieste e va riciclato
+     */
+    bool release(int fd);
+
+    /**
+     * @brief Dimentica un worker (uscito, bloccato o da riciclare)
+     * @return PID da terminare/raccogliere; il chiamante chiude l'fd
+     */
+    pid_t remove(int fd);
+
+    /** @brief Termina e raccoglie tutti i worker (chiusura del server) */
+    void clear();
+
+    size_t size() const { return _workers.size(); }
+
+private:
+    struct Worker {
+        pid_t       pid;
+        std::string key;        ///< interprete + script
+        size_t      served;
+        size_t      max_requests;
+        bool        busy;
+    };
+    typedef std::map<int, Worker> WorkerMap;
+
+    WorkerMap _workers;         ///< socket lato server -> worker
+
+    int spawn(const CGIWorkerSpec& spec, const std::string& key);
+
+    CGIWorkerPool(const CGIWorkerPool&);
+    CGIWorkerPool& operator=(const CGIWorkerPool&);
+};
+
+#endif // CGIWORKERPOOL_HPP
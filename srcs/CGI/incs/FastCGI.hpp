@@ -0,0 +1,75 @@
+/**
+ * @file FastCGI.hpp
+ * @brief Codifica e decodifica dei record del protocollo FastCGI
+ *
+ * Una richiesta verso il backend (php-fpm, server flup, ...) è una
+ * sequenza di record: BEGIN_REQUEST, i PARAMS (le stesse variabili
+ * d'ambiente del CGI), un PARAMS vuoto, lo STDIN e uno STDIN vuoto.
+ * Il backend risponde con record STDOUT (output in formato CGI),
+ * STDERR ed END_REQUEST.
+ *
+ * Con FCGI_KEEP_CONN il backend non chiude la connessione a fine
+ * richiesta: il server la rimette nel FastCGIPool.
+ */
+
+#ifndef FASTCGI_HPP
+#define FASTCGI_HPP
+
+#include "../../../incs/webserv.hpp"
+
+namespace FastCGI {
+    // Tipi di record (specifica FastCGI 1.0)
+    enum RecordType {
+        BEGIN_REQUEST   = 1,
+        ABORT_REQUEST   = 2,
+        END_REQUEST     = 3,
+        PARAMS          = 4,
+        STDIN           = 5,
+        STDOUT          = 6,
+        STDERR          = 7
+    };
+
+    static const unsigned char VERSION_1 = 1;
+    static const unsigned short RESPONDER = 1;
+    static const unsigned char KEEP_CONN = 1;
+    static const size_t HEADER_SIZE = 8;
+    static const size_t MAX_CONTENT = 65535;
+
+    /**
+     * @brief Serializza una richiesta completa (BEGIN, PARAMS, STDIN)
+     * @param id Identificativo della richiesta sulla connessione
+     * @param params Variabili CGI
+     * @param body Body della richiesta HTTP
+     */
+    std::string encodeRequest(unsigned short id, const std::map<std::string, std::string>& params,
+                              const std::string& body);
+}
+
+/**
+ * @brief Parser incrementale dei record ricevuti dal backend
+ *
+ * I byte arrivano in blocchi arbitrari: next() restituisce un record
+ * solo quando header, contenuto e padding sono tutti nel buffer.
+ */
+class FastCGIParser {
+public:
+    FastCGIParser();
+
+    /** @brief Aggiunge byte ricevuti dal backend */
+    void feed(const char* data, size_t length);
+
+    /**
+     * @brief Estrae il prossimo record completo
+     * @return false se servono altri byte
+     */
+    bool next(int& type, std::string& content);
+
+    /** @brief true se non restano byte di un record incompleto */
+    bool empty() const { return _offset == _buffer.size(); }
+
+private:
+    std::string _buffer;
+    size_t      _offset;    ///< Inizio del primo record non ancora estratto
+};
+
+#endif // FASTCGI_HPP
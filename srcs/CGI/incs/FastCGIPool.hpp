@@ -0,0 +1,72 @@
+/**
+ * @file FastCGIPool.hpp
+ * @brief Connessioni persistenti verso i backend FastCGI
+ *
+ * Per ogni indirizzo di fastcgi_pass ("unix:/percorso.sock" oppure
+ * "host:porta") il pool conserva le connessioni rimaste aperte dopo
+ * una richiesta conclusa (FCGI_KEEP_CONN). Una nuova richiesta riusa
+ * una connessione libera e ne apre un'altra solo se non ce ne sono:
+ * le richieste concorrenti si distribuiscono su più connessioni, una
+ * richiesta per connessione alla volta (php-fpm non gestisce il
+ * multiplexing di più id sulla stessa connessione).
+ *
+ * L'indirizzo viene risolto una sola volta, al primo utilizzo.
+ */
+
+#ifndef FASTCGIPOOL_HPP
+#define FASTCGIPOOL_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class FastCGIPool {
+public:
+    /** @brief Connessioni libere conservate al massimo per ogni backend */
+    static const size_t MAX_IDLE = 32;
+
+    FastCGIPool();
+    ~FastCGIPool();
+
+    /**
+     * @brief Restituisce una connessione verso il backend
+     * @param address Valore di fastcgi_pass
+     * @param reused Impostato a true se la connessione viene dal pool
+     * @return fd non bloccante (la connect() può essere ancora in corso)
+     * @throws std::runtime_error se l'indirizzo non è valido o socket() fallisce
+     */
+    int acquire(const std::string& address, bool& reused);
+
+    /**
+     * @brief Rimette nel pool una connessione a fine richiesta
+     * @return false se il pool è pieno: il chiamante chiude l'fd
+     */
+    bool release(const std::string& address, int fd);
+
+    /** @brief Dimentica una connessione libera chiusa dal backend */
+    void remove(int fd);
+
+    /** @brief Chiude tutte le connessioni libere */
+    void clear();
+
+    /** @brief Verifica la sintassi di un indirizzo (per il parser della configurazione) */
+    static bool isValidAddress(const std::string& address);
+
+    size_t idleConnections() const { return _owner.size(); }
+
+private:
+    struct Backend {
+        struct sockaddr_storage addr;
+        socklen_t               addr_len;
+        std::vector<int>        idle;
+    };
+    typedef std::map<std::string, Backend> BackendMap;
+
+    BackendMap                 _backends;
+    std::map<int, std::string> _owner;     ///< fd libero -> indirizzo
+
+    Backend& resolve(const std::string& address);
+
+    FastCGIPool(const FastCGIPool&);
+    FastCGIPool& operator=(const FastCGIPool&);
+};
+
+#endif // FASTCGIPOOL_HPP
@@ -0,0 +1,44 @@
+/**
+ * @file ProcessSpawner.hpp
+ * @brief Avvio degli interpreti CGI senza fork() del server
+ *
+ * fork() duplica le tabelle delle pagine dell'intero server: il costo
+ * cresce con la RSS (cache di file e risposte) e blocca il loop per
+ * millisecondi a ogni script. posix_spawn() in glibc (>= 2.24) usa
+ * clone(CLONE_VM | CLONE_VFORK): il figlio condivide la memoria fino
+ * all'execve e il costo non dipende dalla dimensione del server.
+ *
+ * Redirezione di stdin/stdout e cambio di directory diventano file
+ * actions; SIGPIPE (ignorato dal server) torna al comportamento
+ * standard. Nel figlio non si possono più chiudere i descrittori a
+ * mano: tutti quelli del server devono essere FD_CLOEXEC.
+ *
+ * Dove posix_spawn_file_actions_addchdir_np() non esiste (glibc < 2.29)
+ * si torna a fork() + execve().
+ */
+
+#ifndef PROCESSSPAWNER_HPP
+#define PROCESSSPAWNER_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class ProcessSpawner {
+public:
+    /**
+     * @brief Avvia un programma con stdin/stdout ridiretti
+     * @param argv argv[0] è il percorso dell'eseguibile
+     * @param envp Ambiente completo del figlio
+     * @param stdin_fd Diventa lo stdin del figlio
+     * @param stdout_fd Diventa lo stdout del figlio (può coincidere con stdin_fd)
+     * @param dir Directory di lavoro del figlio
+     * @return PID del figlio
+     * @throws std::runtime_error se l'avvio fallisce
+     */
+    static pid_t spawn(char* const argv[], char* const envp[], int stdin_fd, int stdout_fd,
+                       const std::string& dir);
+
+private:
+    ProcessSpawner();
+};
+
+#endif // PROCESSSPAWNER_HPP
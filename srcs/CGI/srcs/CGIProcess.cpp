@@ -0,0 +1,184 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/CGIProcess.hpp"
+
+#include "../../Utils/incs/Clock.hpp"
+#include "../../Utils/incs/StringUtils.hpp"
+
+CGIProcess::CGIProcess() :
+    pid(-1),
+    client_fd(-1),
+    client_generation(0),
+    stdin_fd(-1),
+    stdout_fd(-1),
+    input(),
+    input_offset(0),
+    deadline(0),
+    paused(false),
+    allow_chunked(false),
+    is_head(false),
+    backend(),
+    reused(false),
+    reusable(false),
+    records(),
+    pool(),
+    frames(),
+    _state(HEADERS),
+    _buffer(),
+    _status(),
+    _headers(),
+    _has_length(false),
+    _has_type(false),
+    _has_date(false),
+    _redirect(false),
+    _started(false),
+    _chunked(false) {}
+
+std::string CGIProcess::consume(const char* data, size_t length, bool& keep_alive) {
+    _buffer.append(data, length);
+    if (!scanHeaders() || _buffer.empty())
+        return "";
+
+    std::string out;
+    if (!_started)
+        out = head(keep_alive, false);
+    out += body();
+    return out;
+}
+
+void CGIProcess::append(const char* data, size_t length) {
+    _buffer.append(data, length);
+}
+
+std::string CGIProcess::finish(bool& keep_alive) {
+    // Header mai terminati: come in passato l'intero output diventa body
+    if (!scanHeaders())
+        headersDone(0);
+
+    std::string out;
+    if (!_started)
+        out = head(keep_alive, true);
+    out += body();
+    if (_chunked)
+        out += HTTP_LAST_CHUNK;
+    return out;
+}
+
+/**
+ * @brief Svuota il body in attesa, nella codifica scelta da head()
+ */
+std::string CGIProcess::body() {
+    std::string out;
+    // HEAD: il body viene scartato
+    if (_chunked)
+        out = StringUtils::chunkEncode(_buffer);
+    else if (!is_head)
+        out.swap(_buffer);
+    _buffer.clear();
+    return out;
+}
+
+bool CGIProcess::scanHeaders() {
+    if (_state == BODY)
+        return true;
+
+    // Gli script possono terminare gli header con CRLF o con LF semplice
+    size_t end = _buffer.find("\r\n\r\n");
+    size_t separator = 4;
+    size_t lf = _buffer.find("\n\n");
+    if (lf != std::string::npos && (end == std::string::npos || lf < end)) {
+        end = lf;
+        separator = 2;
+    }
+
+    if (end != std::string::npos) {
+        parseHeaders(_buffer.substr(0, end));
+        headersDone(end + separator);
+        return true;
+    }
+
+    // Prima riga senza ':' o header enormi: nessun header, tutto è body
+    size_t eol = _buffer.find('\n');
+    bool not_a_header = (eol != std::string::npos && _buffer.substr(0, eol).find(':') == std::string::npos);
+    if (!not_a_header && _buffer.size() <= MAX_HEADER_SIZE)
+        return false;
+    headersDone(0);
+    return true;
+}
+
+void CGIProcess::parseHeaders(const std::string& block) {
+    std::istringstream lines(block);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line[line.length() - 1] == '\r')
+            line.erase(line.length() - 1);
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+
+        std::string name = line.substr(0, colon);
+        size_t start = line.find_first_not_of(" \t", colon + 1);
+        std::string value = (start == std::string::npos) ? "" : line.substr(start);
+
+        if (strcasecmp(name.c_str(), "Status") == 0) {
+            _status = value;
+            continue;
+        }
+        // Gestione della connessione e codifica del body spettano al server
+        if (strcasecmp(name.c_str(), "Connection") == 0
+            || strcasecmp(name.c_str(), "Transfer-Encoding") == 0)
+            continue;
+        if (strcasecmp(name.c_str(), "Content-Length") == 0)
+            _has_length = true;
+        else if (strcasecmp(name.c_str(), "Content-Type") == 0)
+            _has_type = true;
+        else if (strcasecmp(name.c_str(), "Date") == 0)
+            _has_date = true;
+        else if (strcasecmp(name.c_str(), "Location") == 0)
+            _redirect = true;
+        _headers += name + ": " + value + "\r\n";
+    }
+}
+
+void CGIProcess::headersDone(size_t body_start) {
+    _buffer.erase(0, body_start);
+    _state = BODY;
+}
+
+std::string CGIProcess::head(bool& keep_alive, bool at_eof) {
+    std::string status = _status;
+    if (status.empty())
+        status = _redirect ? "302 Found" : "200 OK";
+
+    std::string out = "HTTP/1.1 " + status + "\r\n" + _headers;
+    if (!_has_type)
+        out += "Content-Type: text/html\r\n";
+    if (!_has_date) {
+        out += "Date: ";
+        out.append(Clock::httpDate(), Clock::HTTP_DATE_LENGTH);
+        out += "\r\n";
+    }
+    if (!_has_length) {
+        if (is_head) {
+            // Nessun body da delimitare: con la lunghezza ignota basta
+            // omettere Content-Length e la connessione resta riusabile
+            if (at_eof)
+                out += "Content-Length: " + StringUtils::toString(_buffer.size()) + "\r\n";
+        } else if (at_eof) {
+            // Lo script ha già finito: la lunghezza è nota e la connessione resta riusabile
+            out += "Content-Length: " + StringUtils::toString(_buffer.size()) + "\r\n";
+        } else if (allow_chunked) {
+            // Lunghezza ignota: ogni blocco parte appena arriva, la
+            // connessione resta riusabile
+            out += "Transfer-Encoding: chunked\r\n";
+            _chunked = true;
+        } else {
+            // HTTP/1.0: fine del body segnalata dalla chiusura della connessione
+            keep_alive = false;
+        }
+    }
+    out += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    out += "\r\n";
+    _started = true;
+    return out;
+}
@@ -0,0 +1,152 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/CGIWorkerPool.hpp"
+#include "../incs/ProcessSpawner.hpp"
+
+static void appendLength(std::string& out, size_t length) {
+    out += static_cast<char>((length >> 24) & 0xFF);
+    out += static_cast<char>((length >> 16) & 0xFF);
+    out += static_cast<char>((length >> 8) & 0xFF);
+    out += static_cast<char>(length & 0xFF);
+}
+
+std::string CGIFrame::encodeRequest(const std::map<std::string, std::string>& env, const std::string& body) {
+    std::string block;
+    for (std::map<std::string, std::string>::const_iterator it = env.begin(); it != env.end(); ++it) {
+        block += it->first + "=" + it->second;
+        block += '\0';
+    }
+
+    std::string out;
+    out.reserve(2 * HEADER_SIZE + block.size() + body.size());
+    appendLength(out, block.size());
+    out += block;
+    appendLength(out, body.size());
+    out += body;
+    return out;
+}
+
+// ==================== PARSER ====================
+
+CGIFrameParser::CGIFrameParser() : _buffer(), _offset(0) {}
+
+void CGIFrameParser::feed(const char* data, size_t length) {
+    if (_offset > 0 && _offset >= _buffer.size() / 2) {
+        _buffer.erase(0, _offset);
+        _offset = 0;
+    }
+    _buffer.append(data, length);
+}
+
+bool CGIFrameParser::next(std::string& chunk) {
+    if (_buffer.size() - _offset < CGIFrame::HEADER_SIZE)
+        return false;
+
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(_buffer.data() + _offset);
+    size_t length = (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16)
+                  | (static_cast<size_t>(header[2]) << 8) | header[3];
+    if (_buffer.size() - _offset - CGIFrame::HEADER_SIZE < length)
+        return false;
+
+    chunk.assign(_buffer, _offset + CGIFrame::HEADER_SIZE, length);
+    _offset += CGIFrame::HEADER_SIZE + length;
+    return true;
+}
+
+// ==================== POOL ====================
+
+CGIWorkerPool::CGIWorkerPool() : _workers() {}
+
+CGIWorkerPool::~CGIWorkerPool() {
+    clear();
+}
+
+int CGIWorkerPool::acquire(const CGIWorkerSpec& spec) {
+    std::string key = spec.interpreter + " " + spec.script;
+    size_t count = 0;
+    for (WorkerMap::iterator it = _workers.begin(); it != _workers.end(); ++it) {
+        if (it->second.key != key)
+            continue;
+        if (!it->second.busy) {
+            it->second.busy = true;
+            return it->first;
+        }
+        ++count;
+    }
+    if (count >= spec.max_workers)
+        return -1;
+    return spawn(spec, key);
+}
+
+bool CGIWorkerPool::release(int fd) {
+    WorkerMap::iterator it = _workers.find(fd);
+    if (it == _workers.end())
+        return false;
+    it->second.busy = false;
+    return ++it->second.served < it->second.max_requests;
+}
+
+pid_t CGIWorkerPool::remove(int fd) {
+    WorkerMap::iterator it = _workers.find(fd);
+    if (it == _workers.end())
+        return -1;
+    pid_t pid = it->second.pid;
+    _workers.erase(it);
+    return pid;
+}
+
+void CGIWorkerPool::clear() {
+    for (WorkerMap::iterator it = _workers.begin(); it != _workers.end(); ++it) {
+        close(it->first);
+        kill(it->second.pid, SIGKILL);
+        waitpid(it->second.pid, NULL, 0);
+    }
+    _workers.clear();
+}
+
+/**
+ * @brief Avvia un interprete con stdin e stdout sullo stesso socket
+ *
+ * Stesso avvio degli script forkati (ProcessSpawner): il socket
+ * diventa stdin e stdout, la directory è quella dello script.
+ */
+int CGIWorkerPool::spawn(const CGIWorkerSpec& spec, const std::string& key) {
+    size_t slash = spec.script.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : spec.script.substr(0, slash);
+    std::string name = (slash == std::string::npos) ? spec.script : spec.script.substr(slash + 1);
+    if (dir.empty())
+        dir = "/";
+
+    const char* path = getenv("PATH");
+    std::string path_entry = std::string("PATH=") + (path ? path : "/usr/local/bin:/usr/bin:/bin");
+    std::string pool_entry = "WEBSERV_CGI_POOL=1";
+    char* argv[] = { const_cast<char*>(spec.interpreter.c_str()), const_cast<char*>(name.c_str()), NULL };
+    char* envp[] = { const_cast<char*>(path_entry.c_str()), const_cast<char*>(pool_entry.c_str()), NULL };
+
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1)
+        throw std::runtime_error("CGI worker socketpair() failed: " + std::string(strerror(errno)));
+
+    // Lato server FD_CLOEXEC prima dell'avvio: il worker vede solo il suo
+    fcntl(pair[0], F_SETFL, O_NONBLOCK);
+    fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid;
+    try {
+        pid = ProcessSpawner::spawn(argv, envp, pair[1], pair[1], dir);
+    } catch (...) {
+        close(pair[0]);
+        close(pair[1]);
+        throw;
+    }
+    close(pair[1]);
+
+    Worker worker;
+    worker.pid = pid;
+    worker.key = key;
+    worker.served = 0;
+    worker.max_requests = spec.max_requests;
+    worker.busy = true;
+    _workers[pair[0]] = worker;
+    return pair[0];
+}
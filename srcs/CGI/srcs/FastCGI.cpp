@@ -0,0 +1,98 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/FastCGI.hpp"
+
+/** @brief Header di un record: versione, tipo, id, lunghezza, padding */
+static void appendHeader(std::string& out, int type, unsigned short id, size_t length, size_t padding) {
+    out += static_cast<char>(FastCGI::VERSION_1);
+    out += static_cast<char>(type);
+    out += static_cast<char>((id >> 8) & 0xFF);
+    out += static_cast<char>(id & 0xFF);
+    out += static_cast<char>((length >> 8) & 0xFF);
+    out += static_cast<char>(length & 0xFF);
+    out += static_cast<char>(padding);
+    out += '\0';
+}
+
+/** @brief Uno o più record dello stesso tipo: il contenuto viene spezzato ogni 65535 byte */
+static void appendStream(std::string& out, int type, unsigned short id, const std::string& content) {
+    size_t offset = 0;
+    do {
+        size_t length = std::min(content.size() - offset, FastCGI::MAX_CONTENT);
+        // Padding a multipli di 8 byte, come raccomandato dalla specifica
+        size_t padding = (8 - (length % 8)) % 8;
+        appendHeader(out, type, id, length, padding);
+        out.append(content, offset, length);
+        out.append(padding, '\0');
+        offset += length;
+    } while (offset < content.size());
+}
+
+/** @brief Lunghezza di nome o valore: 1 byte sotto 128, altrimenti 4 byte */
+static void appendLength(std::string& out, size_t length) {
+    if (length < 128) {
+        out += static_cast<char>(length);
+        return;
+    }
+    out += static_cast<char>(((length >> 24) & 0x7F) | 0x80);
+    out += static_cast<char>((length >> 16) & 0xFF);
+    out += static_cast<char>((length >> 8) & 0xFF);
+    out += static_cast<char>(length & 0xFF);
+}
+
+std::string FastCGI::encodeRequest(unsigned short id, const std::map<std::string, std::string>& params,
+                                   const std::string& body) {
+    std::string out;
+
+    std::string begin(8, '\0');
+    begin[0] = static_cast<char>((RESPONDER >> 8) & 0xFF);
+    begin[1] = static_cast<char>(RESPONDER & 0xFF);
+    begin[2] = static_cast<char>(KEEP_CONN);
+    appendStream(out, BEGIN_REQUEST, id, begin);
+
+    std::string pairs;
+    for (std::map<std::string, std::string>::const_iterator it = params.begin(); it != params.end(); ++it) {
+        appendLength(pairs, it->first.size());
+        appendLength(pairs, it->second.size());
+        pairs += it->first;
+        pairs += it->second;
+    }
+    if (!pairs.empty())
+        appendStream(out, PARAMS, id, pairs);
+    appendStream(out, PARAMS, id, "");
+
+    if (!body.empty())
+        appendStream(out, STDIN, id, body);
+    appendStream(out, STDIN, id, "");
+    return out;
+}
+
+// ==================== PARSER ====================
+
+FastCGIParser::FastCGIParser() : _buffer(), _offset(0) {}
+
+void FastCGIParser::feed(const char* data, size_t length) {
+    // Compatta solo quando i record già estratti sono la maggior parte del buffer
+    if (_offset > 0 && _offset >= _buffer.size() / 2) {
+        _buffer.erase(0, _offset);
+        _offset = 0;
+    }
+    _buffer.append(data, length);
+}
+
+bool FastCGIParser::next(int& type, std::string& content) {
+    if (_buffer.size() - _offset < FastCGI::HEADER_SIZE)
+        return false;
+
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(_buffer.data() + _offset);
+    size_t length = (static_cast<size_t>(header[4]) << 8) | header[5];
+    size_t padding = header[6];
+    size_t total = FastCGI::HEADER_SIZE + length + padding;
+    if (_buffer.size() - _offset < total)
+        return false;
+
+    type = header[1];
+    content.assign(_buffer, _offset + FastCGI::HEADER_SIZE, length);
+    _offset += total;
+    return true;
+}
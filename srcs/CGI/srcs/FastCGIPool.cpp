@@ -0,0 +1,111 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/FastCGIPool.hpp"
+
+FastCGIPool::FastCGIPool() : _backends(), _owner() {}
+
+FastCGIPool::~FastCGIPool() {
+    clear();
+}
+
+bool FastCGIPool::isValidAddress(const std::string& address) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        std::string path = address.substr(5);
+        return !path.empty() && path.size() < sizeof(((struct sockaddr_un*)0)->sun_path);
+    }
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size())
+        return false;
+    std::string port = address.substr(colon + 1);
+    for (size_t i = 0; i < port.size(); ++i) {
+        if (!isdigit(static_cast<unsigned char>(port[i])))
+            return false;
+    }
+    long number = atol(port.c_str());
+    return port.size() <= 5 && number > 0 && number <= 65535;
+}
+
+FastCGIPool::Backend& FastCGIPool::resolve(const std::string& address) {
+    BackendMap::iterator it = _backends.find(address);
+    if (it != _backends.end())
+        return it->second;
+
+    if (!isValidAddress(address))
+        throw std::runtime_error("Invalid fastcgi_pass address: " + address);
+
+    Backend backend;
+    memset(&backend.addr, 0, sizeof(backend.addr));
+    if (address.compare(0, 5, "unix:") == 0) {
+        struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&backend.addr);
+        un->sun_family = AF_UNIX;
+        strncpy(un->sun_path, address.c_str() + 5, sizeof(un->sun_path) - 1);
+        backend.addr_len = sizeof(struct sockaddr_un);
+    } else {
+        size_t colon = address.rfind(':');
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        struct addrinfo* result = NULL;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || !result)
+            throw std::runtime_error("Cannot resolve fastcgi_pass address: " + address);
+        memcpy(&backend.addr, result->ai_addr, result->ai_addrlen);
+        backend.addr_len = result->ai_addrlen;
+        freeaddrinfo(result);
+    }
+    return _backends.insert(std::make_pair(address, backend)).first->second;
+}
+
+int FastCGIPool::acquire(const std::string& address, bool& reused) {
+    Backend& backend = resolve(address);
+
+    if (!backend.idle.empty()) {
+        int fd = backend.idle.back();
+        backend.idle.pop_back();
+        _owner.erase(fd);
+        reused = true;
+        return fd;
+    }
+
+    int fd = socket(backend.addr.ss_family, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw std::runtime_error("FastCGI socket() failed: " + std::string(strerror(errno)));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // Connessione non bloccante: l'esito non viene letto da errno, un
+    // backend irraggiungibile fa fallire la prima send() (-> 502)
+    connect(fd, reinterpret_cast<struct sockaddr*>(&backend.addr), backend.addr_len);
+    reused = false;
+    return fd;
+}
+
+bool FastCGIPool::release(const std::string& address, int fd) {
+    BackendMap::iterator it = _backends.find(address);
+    if (it == _backends.end() || it->second.idle.size() >= MAX_IDLE)
+        return false;
+    it->second.idle.push_back(fd);
+    _owner[fd] = address;
+    return true;
+}
+
+void FastCGIPool::remove(int fd) {
+    std::map<int, std::string>::iterator owner = _owner.find(fd);
+    if (owner == _owner.end())
+        return;
+    std::vector<int>& idle = _backends[owner->second].idle;
+    idle.erase(std::remove(idle.begin(), idle.end(), fd), idle.end());
+    _owner.erase(owner);
+}
+
+void FastCGIPool::clear() {
+    for (std::map<int, std::string>::iterator it = _owner.begin(); it != _owner.end(); ++it)
+        close(it->first);
+    _owner.clear();
+    for (BackendMap::iterator it = _backends.begin(); it != _backends.end(); ++it)
+        it->second.idle.clear();
+}
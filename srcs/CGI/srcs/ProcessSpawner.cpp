@@ -0,0 +1,79 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/ProcessSpawner.hpp"
+
+#if defined(__APPLE__) || (defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29)))
+# define WEBSERV_SPAWN_CHDIR 1
+#endif
+
+#ifdef WEBSERV_SPAWN_CHDIR
+
+pid_t ProcessSpawner::spawn(char* const argv[], char* const envp[], int stdin_fd, int stdout_fd,
+                            const std::string& dir) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&actions) != 0)
+        throw std::runtime_error("posix_spawn_file_actions_init() failed");
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        throw std::runtime_error("posix_spawnattr_init() failed");
+    }
+
+    int rc = posix_spawn_file_actions_adddup2(&actions, stdin_fd, STDIN_FILENO);
+    if (rc == 0)
+        rc = posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+    if (rc == 0)
+        rc = posix_spawn_file_actions_addclose(&actions, stdin_fd);
+    if (rc == 0 && stdout_fd != stdin_fd)
+        rc = posix_spawn_file_actions_addclose(&actions, stdout_fd);
+    if (rc == 0)
+        rc = posix_spawn_file_actions_addchdir_np(&actions, dir.c_str());
+
+    sigset_t defaults;
+    sigset_t mask;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigemptyset(&mask);
+    if (rc == 0)
+        rc = posix_spawnattr_setsigdefault(&attr, &defaults);
+    if (rc == 0)
+        rc = posix_spawnattr_setsigmask(&attr, &mask);
+    if (rc == 0)
+        rc = posix_spawnattr_setflags(&attr, static_cast<short>(POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK));
+
+    // posix_spawn() restituisce il codice d'errore, anche quando è
+    // l'execve() a fallire: nessun figlio da raccogliere in quel caso
+    pid_t pid = -1;
+    if (rc == 0)
+        rc = posix_spawn(&pid, argv[0], &actions, &attr, argv, envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc != 0)
+        throw std::runtime_error("posix_spawn() failed for " + std::string(argv[0]) + ": " + strerror(rc));
+    return pid;
+}
+
+#else
+
+pid_t ProcessSpawner::spawn(char* const argv[], char* const envp[], int stdin_fd, int stdout_fd,
+                            const std::string& dir) {
+    pid_t pid = fork();
+    if (pid == -1)
+        throw std::runtime_error("Fork failed: " + std::string(strerror(errno)));
+
+    if (pid == 0) {
+        if (dup2(stdin_fd, STDIN_FILENO) == -1 || dup2(stdout_fd, STDOUT_FILENO) == -1)
+            _exit(1);
+        close(stdin_fd);
+        if (stdout_fd != stdin_fd)
+            close(stdout_fd);
+        signal(SIGPIPE, SIG_DFL);
+        if (chdir(dir.c_str()) == -1)
+            _exit(1);
+        execve(argv[0], argv, envp);
+        _exit(1);
+    }
+    return pid;
+}
+
+#endif
@@ -19,6 +19,10 @@ private:
     std::set<std::string> _allowed_mime_types;
     std::string _upload_dir;
     std::map<std::string, std::string> _cgiInterpreters;
+    bool _stub_status;
+    std::string _fastcgi_pass;
+    size_t _cgi_pool;
+    size_t _cgi_pool_max_requests;
       static const bool DEBUG = true;
 
 
@@ -37,7 +41,11 @@ public:
         _allow_upload(false),
         _allow_delete(false),
         _allowed_mime_types(),
-        _cgiInterpreters()
+        _cgiInterpreters(),
+        _stub_status(false),
+        _fastcgi_pass(""),
+        _cgi_pool(0),
+        _cgi_pool_max_requests(1000)
     {}
     
     ~LocationConfig();
@@ -89,6 +97,20 @@ void clearAllowedMethods();
     std::string getCgiInterpreter(const std::string& ext) const;
     const std::map<std::string, std::string>& getCgiInterpreters() const;
     
+    // Location che serve le statistiche del server ("stub_status")
+    void setStubStatus(bool enabled) { _stub_status = enabled; }
+    bool isStubStatus() const { return _stub_status; }
+
+    // Backend FastCGI della location ("fastcgi_pass unix:/path.sock|host:port")
+    void setFastCgiPass(const std::string& address) { _fastcgi_pass = address; }
+    const std::string& getFastCgiPass() const { return _fastcgi_pass; }
+
+    // Worker persistenti per coppia interprete/script ("cgi_pool N", 0 = off)
+    void setCgiPool(size_t workers) { _cgi_pool = workers; }
+    size_t getCgiPool() const { return _cgi_pool; }
+    void setCgiPoolMaxRequests(size_t requests) { _cgi_pool_max_requests = requests; }
+    size_t getCgiPoolMaxRequests() const { return _cgi_pool_max_requests; }
+
     // Verifica se un'estensione è configurata come CGI
     bool isCGIExtension(const std::string& ext) const {
         return _cgiInterpreters.find(ext) != _cgiInterpreters.end();
@@ -31,12 +31,27 @@ private:
 
 
     std::string _upload_dir;  // Add this member
+    std::string _event_backend;  // "epoll", "poll" or empty for platform default
+    int _worker_processes;       // 1 = single process, no master
+    bool _worker_affinity_auto;  // "worker_processes auto": one worker pinned per core
+    size_t _pipeline_depth;      // max pipelined responses queued per connection
+    size_t _accept_budget;       // max connections accepted per listener wakeup
+    bool _deferred_accept;       // TCP_DEFER_ACCEPT: wake up only when the request arrives
+    size_t _open_file_cache_max; // 0 = open file cache off
+    time_t _open_file_cache_valid;
+    size_t _response_cache_size; // byte budget, 0 = response cache off
+    size_t _response_cache_max_file;
+    unsigned long _keepalive_timeout;       // ms, 0 = no timeout
+    unsigned long _client_header_timeout;
+    unsigned long _client_body_timeout;
+    unsigned long _send_timeout;
 
 public:
     ServerConfig();
     ServerConfig(const std::string& configFilePath); // ADD THIS
     void loadConfig(const std::string& configFilePath);
     std::string getFullPath(const std::string& uri) const;  // Add this line
+    void getFullPath(const std::string& uri, std::string& out) const;
 
     // Setters
     void setPort(int port);
@@ -64,6 +79,36 @@ public:
     const std::string& getRoot() const;
     const std::string& getIndex() const;
 
+    // Event loop backend selected with the "use" directive
+    void setEventBackend(const std::string& backend);
+    const std::string& getEventBackend() const;
+
+    // Multi-process mode ("worker_processes N|auto")
+    int getWorkerProcesses() const;
+    bool isWorkerAffinityAuto() const;
+
+    // HTTP/1.1 pipelining ("pipeline_depth N")
+    size_t getPipelineDepth() const;
+
+    // Accept path ("accept_budget N", "deferred_accept on|off")
+    size_t getAcceptBudget() const;
+    bool isDeferredAccept() const;
+
+    // Open file cache ("open_file_cache N|off", "open_file_cache_valid S")
+    size_t getOpenFileCacheMax() const;
+    time_t getOpenFileCacheValid() const;
+
+    // In-memory response cache ("response_cache SIZE|off", "response_cache_max_file SIZE")
+    size_t getResponseCacheSize() const;
+    size_t getResponseCacheMaxFile() const;
+
+    // Connection timeouts in ms ("keepalive_timeout", "client_header_timeout",
+    // "client_body_timeout", "send_timeout": 75s, 500ms, 1m; 0 = no timeout)
+    unsigned long getKeepaliveTimeout() const;
+    unsigned long getClientHeaderTimeout() const;
+    unsigned long getClientBodyTimeout() const;
+    unsigned long getSendTimeout() const;
+
 
     void parseLocationBlock(std::ifstream& configFile, const std::string& path);
 
@@ -16,7 +16,55 @@
 
 #include "../../Utils/incs/FileHandler.hpp"
 #include "../../Config/incs/LocationConfig.hpp"
+#include "../../CGI/incs/FastCGIPool.hpp"
+
+
+/**
+ * @brief Converte una dimensione con suffisso opzionale k/m/g (es. "64k")
+ * @return false se il valore non è un numero valido
+ */
+static bool parseSize(const std::string& value, size_t& result) {
+    if (value.empty() || !isdigit(static_cast<unsigned char>(value[0])))
+        return false;
+    char* end = NULL;
+    unsigned long number = strtoul(value.c_str(), &end, 10);
+    std::string suffix(end);
+    size_t multiplier = 1;
+    if (suffix == "k" || suffix == "K")
+        multiplier = 1024;
+    else if (suffix == "m" || suffix == "M")
+        multiplier = 1024 * 1024;
+    else if (suffix == "g" || suffix == "G")
+        multiplier = 1024 * 1024 * 1024;
+    else if (!suffix.empty())
+        return false;
+    result = static_cast<size_t>(number) * multiplier;
+    return true;
+}
 
+/**
+ * @brief Converte una durata con suffisso opzionale ms/s/m/h (es. "30s", senza suffisso secondi)
+ * @param result Durata in millisecondi
+ * @return false se il valore non è un numero valido
+ */
+static bool parseTime(const std::string& value, unsigned long& result) {
+    if (value.empty() || !isdigit(static_cast<unsigned char>(value[0])))
+        return false;
+    char* end = NULL;
+    unsigned long number = strtoul(value.c_str(), &end, 10);
+    std::string suffix(end);
+    unsigned long multiplier = 1000;
+    if (suffix == "ms")
+        multiplier = 1;
+    else if (suffix == "m")
+        multiplier = 60 * 1000;
+    else if (suffix == "h")
+        multiplier = 60 * 60 * 1000;
+    else if (!suffix.empty() && suffix != "s")
+        return false;
+    result = number * multiplier;
+    return true;
+}
 
 
 const std::set<std::string>& ServerConfig::getCgiExtensions() const {
@@ -28,17 +76,19 @@ const std::vector<LocationConfig>& ServerConfig::getLocations() const {
 }
 
 const LocationConfig& ServerConfig::getLocationForPath(const std::string& path) const {
-    std::string clean_path = path;
         std::cout << "DEBUG: Available locations:\n";
 
     for (std::vector<LocationConfig>::const_iterator it = _locations.begin();
          it != _locations.end(); ++it) {
         std::cout << " - '" << it->getPath() << "'\n";
     }
-    // Normalize path
-    if (clean_path.empty() || clean_path[0] != '/') {
-        clean_path = "/" + clean_path;
+    // Normalize path (il percorso di una richiesta inizia già con '/':
+    // la copia serve solo negli altri casi)
+    std::string normalized;
+    if (path.empty() || path[0] != '/') {
+        normalized = "/" + path;
     }
+    const std::string& clean_path = normalized.empty() ? path : normalized;
 
     const LocationConfig* best_match = NULL;
     size_t best_length = 0;
@@ -80,20 +130,30 @@ const LocationConfig& ServerConfig::getLocationForPath(const std::string& path)
 }
 
 std::string ServerConfig::getFullPath(const std::string& uri) const {
-    std::string path = this->root;  // Access class member
+    std::string path;
+    getFullPath(uri, path);
+    return path;
+}
+
+void ServerConfig::getFullPath(const std::string& uri, std::string& out) const {
+    // Costruito direttamente in out: con un buffer riusato tra le
+    // richieste non serve nessuna allocazione
+    out.assign(this->root);
     
     // Remove trailing slash from root
-    if (!path.empty() && path[path.length()-1] == '/') {
-        path.erase(path.length()-1);
+    if (!out.empty() && out[out.length()-1] == '/') {
+        out.erase(out.length()-1);
     }
     
     // Add sanitized URI path
-    std::string uri_path = uri;
-    if (!uri_path.empty() && uri_path[0] == '/') {
-        uri_path.erase(0, 1);
+    out += '/';
+    if (!uri.empty() && uri[0] == '/') {
+        out.append(uri, 1, std::string::npos);
+    } else {
+        out += uri;
     }
     
-    return FileHandler::sanitizePath(path + "/" + uri_path);
+    FileHandler::sanitizePathInPlace(out);
 }
 
 
@@ -101,13 +161,39 @@ ServerConfig::ServerConfig() :
     port(8080),
     client_max_body_size(1048576), // 1MB default
     root(""),
-    index("index.html") {}
+    index("index.html"),
+    _worker_processes(1),
+    _worker_affinity_auto(false),
+    _pipeline_depth(DEFAULT_PIPELINE_DEPTH),
+    _accept_budget(DEFAULT_ACCEPT_BUDGET),
+    _deferred_accept(false),
+    _open_file_cache_max(0),
+    _open_file_cache_valid(60),
+    _response_cache_size(0),
+    _response_cache_max_file(64 * 1024),
+    _keepalive_timeout(DEFAULT_KEEPALIVE_TIMEOUT),
+    _client_header_timeout(DEFAULT_CLIENT_TIMEOUT),
+    _client_body_timeout(DEFAULT_CLIENT_TIMEOUT),
+    _send_timeout(DEFAULT_CLIENT_TIMEOUT) {}
 
 ServerConfig::ServerConfig(const std::string& configFilePath) : 
     port(8080), 
     client_max_body_size(1048576), // 1MB default - FIXED!
     root(""), 
-    index("") {
+    index(""),
+    _worker_processes(1),
+    _worker_affinity_auto(false),
+    _pipeline_depth(DEFAULT_PIPELINE_DEPTH),
+    _accept_budget(DEFAULT_ACCEPT_BUDGET),
+    _deferred_accept(false),
+    _open_file_cache_max(0),
+    _open_file_cache_valid(60),
+    _response_cache_size(0),
+    _response_cache_max_file(64 * 1024),
+    _keepalive_timeout(DEFAULT_KEEPALIVE_TIMEOUT),
+    _client_header_timeout(DEFAULT_CLIENT_TIMEOUT),
+    _client_body_timeout(DEFAULT_CLIENT_TIMEOUT),
+    _send_timeout(DEFAULT_CLIENT_TIMEOUT) {
     loadConfig(configFilePath);
 }
 
@@ -162,6 +248,42 @@ if (!configFile.is_open())
         std::string key;
         iss >> key;
 
+        // Global directives: accepted inside or outside the server block
+        if (key == "use") {
+            std::string backend;
+            iss >> backend;
+            if (!backend.empty() && backend[backend.length()-1] == ';') {
+                backend.erase(backend.length()-1);
+            }
+            if (backend != "epoll" && backend != "poll") {
+                throw std::runtime_error("Invalid event backend '" + backend + "' (expected epoll or poll): " + configFilePath);
+            }
+            _event_backend = backend;
+            std::cerr << "DEBUG: Set event backend to " << _event_backend << std::endl;
+            continue;
+        }
+
+        if (key == "worker_processes") {
+            std::string value;
+            iss >> value;
+            if (!value.empty() && value[value.length()-1] == ';') {
+                value.erase(value.length()-1);
+            }
+            if (value == "auto") {
+                long cores = sysconf(_SC_NPROCESSORS_ONLN);
+                _worker_processes = (cores > 0) ? static_cast<int>(cores) : 1;
+                _worker_affinity_auto = true;
+            } else {
+                _worker_processes = atoi(value.c_str());
+                _worker_affinity_auto = false;
+                if (_worker_processes <= 0) {
+                    throw std::runtime_error("Invalid worker_processes '" + value + "' (expected a positive number or auto): " + configFilePath);
+                }
+            }
+            std::cerr << "DEBUG: Set worker_processes to " << _worker_processes << std::endl;
+            continue;
+        }
+
         if (key == "server" && line.find("{") != std::string::npos) {
             inServerBlock = true;
             hasServerBlock = true;
@@ -203,6 +325,117 @@ if (!configFile.is_open())
                 std::cerr << "DEBUG: Parsing error_page directive: code=" << code << ", path=" << path << std::endl;
                 error_pages[code] = path;
                 std::cerr << "DEBUG: Added error page to server config" << std::endl;
+            } else if (key == "pipeline_depth") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                int depth = atoi(value.c_str());
+                if (depth <= 0) {
+                    throw std::runtime_error("Invalid pipeline_depth '" + value + "' (expected a positive number): " + configFilePath);
+                }
+                _pipeline_depth = static_cast<size_t>(depth);
+                std::cerr << "DEBUG: Set pipeline_depth to " << _pipeline_depth << std::endl;
+            } else if (key == "accept_budget") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                int budget = atoi(value.c_str());
+                if (budget <= 0) {
+                    throw std::runtime_error("Invalid accept_budget '" + value + "' (expected a positive number): " + configFilePath);
+                }
+                _accept_budget = static_cast<size_t>(budget);
+                std::cerr << "DEBUG: Set accept_budget to " << _accept_budget << std::endl;
+            } else if (key == "deferred_accept") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                if (value != "on" && value != "off") {
+                    throw std::runtime_error("Invalid deferred_accept '" + value + "' (expected on or off): " + configFilePath);
+                }
+                _deferred_accept = (value == "on");
+                std::cerr << "DEBUG: Set deferred_accept to " << value << std::endl;
+            } else if (key == "open_file_cache") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                int entries = (value == "off") ? 0 : atoi(value.c_str());
+                if (entries < 0 || (entries == 0 && value != "off" && value != "0")) {
+                    throw std::runtime_error("Invalid open_file_cache '" + value + "' (expected a number of entries or off): " + configFilePath);
+                }
+                _open_file_cache_max = static_cast<size_t>(entries);
+                std::cerr << "DEBUG: Set open_file_cache to " << _open_file_cache_max << " entries" << std::endl;
+            } else if (key == "open_file_cache_valid") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                if (!value.empty() && value[value.length()-1] == 's') {
+                    value.erase(value.length()-1);
+                }
+                int seconds = atoi(value.c_str());
+                if (seconds <= 0) {
+                    throw std::runtime_error("Invalid open_file_cache_valid '" + value + "' (expected seconds): " + configFilePath);
+                }
+                _open_file_cache_valid = seconds;
+                std::cerr << "DEBUG: Set open_file_cache_valid to " << _open_file_cache_valid << "s" << std::endl;
+            } else if (key == "response_cache" || key == "response_cache_max_file") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                size_t bytes = 0;
+                if (!(key == "response_cache" && value == "off") && !parseSize(value, bytes)) {
+                    throw std::runtime_error("Invalid " + key + " '" + value + "' (expected a size such as 64k or 8m): " + configFilePath);
+                }
+                if (key == "response_cache") {
+                    _response_cache_size = bytes;
+                } else {
+                    _response_cache_max_file = bytes;
+                }
+                std::cerr << "DEBUG: Set " << key << " to " << bytes << " bytes" << std::endl;
+            } else if (key == "client_max_body_size") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                size_t bytes = 0;
+                if (!parseSize(value, bytes)) {
+                    throw std::runtime_error("Invalid client_max_body_size '" + value + "' (expected a size such as 1m or 4g): " + configFilePath);
+                }
+                client_max_body_size = bytes;
+                std::cerr << "DEBUG: Set client_max_body_size to " << bytes << " bytes" << std::endl;
+            } else if (key == "keepalive_timeout" || key == "client_header_timeout"
+                       || key == "client_body_timeout" || key == "send_timeout") {
+                std::string value;
+                iss >> value;
+                if (!value.empty() && value[value.length()-1] == ';') {
+                    value.erase(value.length()-1);
+                }
+                unsigned long ms = 0;
+                if (!parseTime(value, ms)) {
+                    throw std::runtime_error("Invalid " + key + " '" + value + "' (expected a time such as 30s or 500ms): " + configFilePath);
+                }
+                if (key == "keepalive_timeout") {
+                    _keepalive_timeout = ms;
+                } else if (key == "client_header_timeout") {
+                    _client_header_timeout = ms;
+                } else if (key == "client_body_timeout") {
+                    _client_body_timeout = ms;
+                } else {
+                    _send_timeout = ms;
+                }
+                std::cerr << "DEBUG: Set " << key << " to " << ms << " ms" << std::endl;
             } else if (key == "location") {
                 std::string path;
                 iss >> path;
@@ -346,6 +579,43 @@ void ServerConfig::parseLocationBlock(std::ifstream& configFile, const std::stri
             location.setAutoIndex(autoindex_enabled);
             std::cout << "DEBUG: Set autoindex to " << (autoindex_enabled ? "true" : "false") << " for location '" << path << "'" << std::endl;
         }
+        else if (key == "stub_status" || key == "stub_status;") {
+            // Pagina di statistiche del server (come stub_status di nginx)
+            location.setStubStatus(true);
+        }
+        else if (key == "fastcgi_pass") {
+            std::string address;
+            iss >> address;
+            if (!address.empty() && address[address.length()-1] == ';') {
+                address.erase(address.length()-1);
+            }
+            if (!FastCGIPool::isValidAddress(address)) {
+                throw std::runtime_error("Invalid fastcgi_pass '" + address + "' (expected unix:/path.sock or host:port) in location " + path);
+            }
+            location.setFastCgiPass(address);
+        }
+        else if (key == "cgi_pool" || key == "cgi_pool_max_requests") {
+            std::string value;
+            iss >> value;
+            if (!value.empty() && value[value.length()-1] == ';') {
+                value.erase(value.length()-1);
+            }
+            // cgi_pool: processi per script (0/off = fork per richiesta);
+            // cgi_pool_max_requests: richieste prima del riciclo
+            bool pool = (key == "cgi_pool");
+            bool off = (pool && value == "off");
+            long min = pool ? 0 : 1;
+            long max = pool ? 256 : 1000000;
+            char* end = NULL;
+            long number = off ? 0 : strtol(value.c_str(), &end, 10);
+            if (!off && (value.empty() || *end != '\0' || number < min || number > max)) {
+                throw std::runtime_error("Invalid " + key + " '" + value + "' in location " + path);
+            }
+            if (pool)
+                location.setCgiPool(static_cast<size_t>(number));
+            else
+                location.setCgiPoolMaxRequests(static_cast<size_t>(number));
+        }
         else if (key == "allow_methods") {
             std::string method;
             while (iss >> method) {
@@ -431,4 +701,64 @@ const std::string& ServerConfig::getRoot() const {
 // Implementazione di getIndex()
 const std::string& ServerConfig::getIndex() const {
     return this->index;
+}
+
+void ServerConfig::setEventBackend(const std::string& backend) {
+    _event_backend = backend;
+}
+
+const std::string& ServerConfig::getEventBackend() const {
+    return _event_backend;
+}
+
+int ServerConfig::getWorkerProcesses() const {
+    return _worker_processes;
+}
+
+bool ServerConfig::isWorkerAffinityAuto() const {
+    return _worker_affinity_auto;
+}
+
+size_t ServerConfig::getPipelineDepth() const {
+    return _pipeline_depth;
+}
+
+size_t ServerConfig::getAcceptBudget() const {
+    return _accept_budget;
+}
+
+bool ServerConfig::isDeferredAccept() const {
+    return _deferred_accept;
+}
+
+size_t ServerConfig::getOpenFileCacheMax() const {
+    return _open_file_cache_max;
+}
+
+time_t ServerConfig::getOpenFileCacheValid() const {
+    return _open_file_cache_valid;
+}
+
+size_t ServerConfig::getResponseCacheSize() const {
+    return _response_cache_size;
+}
+
+size_t ServerConfig::getResponseCacheMaxFile() const {
+    return _response_cache_max_file;
+}
+
+unsigned long ServerConfig::getKeepaliveTimeout() const {
+    return _keepalive_timeout;
+}
+
+unsigned long ServerConfig::getClientHeaderTimeout() const {
+    return _client_header_timeout;
+}
+
+unsigned long ServerConfig::getClientBodyTimeout() const {
+    return _client_body_timeout;
+}
+
+unsigned long ServerConfig::getSendTimeout() const {
+    return _send_timeout;
 }
\ No newline at end of file
@@ -14,7 +14,7 @@
  * 2. Accumulo dati ricevuti (appendRequestData)
  * 3. Verifica completezza richiesta (isRequestComplete)
  * 4. Parsing richiesta HTTP (parseRequest)
- * 5. Elaborazione tramite server (handleRequest)
+ * 5. Elaborazione tramite server (Server::processRequest)
  * 6. Invio risposta (send_pending_data)
  * 7. Reset per nuova richiesta o chiusura
  */
@@ -25,6 +25,11 @@
 #include "../../../incs/webserv.hpp"
 
 #include "../../HTTP/incs/Request.hpp"
+#include "../../HTTP/incs/Response.hpp"
+#include "../../HTTP/incs/BodySink.hpp"
+#include "../../HTTP/incs/MultipartParser.hpp"
+
+#include "OutputQueue.hpp"
 
 /**
  * @brief Classe che rappresenta un client connesso al server
@@ -40,40 +45,30 @@ class Client {
 private:
     // ==================== MEMBRI PRIVATI ====================
     
-    /** @brief Buffer per dati in attesa di essere inviati al client */
-    std::string pending_data;
-    
     /** @brief Flag per gestione keep-alive della connessione */
     bool keep_alive;
 
+    /** @brief Capacità di request_data conservata tra una richiesta e l'altra */
+    static const size_t IDLE_BUFFER_MAX = 1024;
+
     // ==================== METODI HELPER PRIVATI ====================
     
     /**
-     * @brief Estrae il Content-Length dagli header HTTP
-     * @param headers Stringa contenente gli header HTTP
-     * @return Dimensione del body in bytes, 0 se non specificata
-     * 
-     * REFACTORING: Estratta da isRequestComplete() per migliorare leggibilità
+     * @brief Sposta su disco i byte di body presenti nel buffer
+     * @return true quando il body è completo
+     * @throws std::runtime_error se la scrittura su disco fallisce o il multipart è malformato
      */
-    size_t extractContentLength(const std::string& headers) const;
-    
+    bool spoolBody();
+
+    /** @brief Scrive nel sink aperto un tratto del buffer e lo rimuove */
+    void writeBody(size_t start, size_t length);
+
     /**
-     * @brief Verifica se la richiesta è di tipo GET o HEAD (senza body)
-     * @return true se la richiesta non dovrebbe avere un body
-     * 
-     * REFACTORING: Estratta da isRequestComplete() per semplificare la logica
+     * @brief Esegue RequestParser::feed() sul buffer
+     * @throws std::runtime_error con il codice dell'errore di parsing
      */
-    bool isMethodWithoutBody() const;
+    RequestParser::Status feedParser();
     
-    /**
-     * @brief Valida la dimensione del body contro i limiti configurati
-     * @param content_length Dimensione dichiarata del body
-     * @param body_received Dimensione effettiva ricevuta
-     * @throws std::runtime_error se il body è troppo grande
-     * 
-     * REFACTORING: Estratta da isRequestComplete() per centralizzare i controlli
-     */
-    void validateBodySize(size_t content_length, size_t body_received) const;
 
 public:
     // ==================== MEMBRI PUBBLICI ====================
@@ -83,10 +78,44 @@ public:
     
     /** @brief Oggetto richiesta HTTP parsata */
     Request request;
+
+    /** @brief Memoria della richiesta corrente (header), azzerata da nextRequest() */
+    Arena arena;
     
     /** @brief Buffer grezzo dei dati ricevuti dal client */
     std::string request_data;
     
+    /** @brief Parser incrementale che lavora su request_data */
+    RequestParser parser;
+
+    /** @brief File temporaneo dell'upload binario in corso (chiuso se il body resta in memoria) */
+    BodySink body;
+
+    /** @brief Upload multipart in corso: le parti vanno su disco durante la ricezione */
+    MultipartUpload upload;
+    
+    /** @brief Coda dei dati in attesa di essere inviati al client */
+    OutputQueue output;
+    
+    /** @brief Chiudere la connessione appena la coda di output è vuota */
+    bool close_after_flush;
+    
+    /** @brief Script CGI che sta producendo la risposta corrente (NULL se nessuno) */
+    CGIProcess* cgi;
+
+    /** @brief Autoindex ancora da generare per la risposta corrente (NULL se nessuno) */
+    DirectoryListing* listing;
+
+    /** @brief Scadenza armata per la connessione (vedi Server::armClientTimer) */
+    enum Timer { TIMER_NONE, TIMER_HEADER, TIMER_BODY, TIMER_SEND, TIMER_KEEPALIVE };
+    Timer timer;
+
+    /** @brief Richieste completate sulla connessione (0: in attesa della prima) */
+    size_t requests_served;
+
+    /** @brief true se la risposta corrente viene ancora prodotta (CGI o autoindex) */
+    bool isProducing() const { return cgi != NULL || listing != NULL; }
+    
     // ==================== GESTIONE RICHIESTE ====================
     
     /**
@@ -111,19 +140,35 @@ public:
      */
     void reset() {
         request_data.clear();
-        // Reset other request-related state
+        parser.reset();
+        body.discard();
+        upload.discard();
+        request = Request();
+        arena.reset();
     }
 
+    /**
+     * @brief Passa alla richiesta successiva (pipelining)
+     * 
+     * Scarta solo i byte della richiesta appena elaborata: eventuali
+     * richieste pipelined già ricevute restano nel buffer.
+     */
+    void nextRequest();
+
+    /** @brief true se il body della richiesta corrente va su disco */
+    bool isSpooling() const { return body.isOpen() || upload.isOpen(); }
+
+    /** @brief true se nel buffer ci sono byte non ancora esaminati dal parser */
+    bool hasUnparsedData() const { return request_data.size() > parser.position(); }
+
     /**
      * @brief Verifica se la richiesta HTTP è completa
      * @return true se la richiesta è completa e pronta per il parsing
+     * @throws std::runtime_error se la richiesta è malformata o troppo grande
      * 
-     * Controlla:
-     * - Presenza di linea vuota che separa header da body
-     * - Completezza del body (se Content-Length specificato)
-     * - Terminazione corretta per richieste chunked
-     * 
-     * REFACTORING: Semplificata utilizzando metodi helper privati
+     * Il parser riprende dall'ultimo byte esaminato: i dati già
+     * ricevuti non vengono scanditi di nuovo ad ogni recv().
+     * Durante un upload i byte del body finiscono su disco.
      */
     bool isRequestComplete();
 
@@ -148,51 +193,28 @@ public:
     // ==================== GESTIONE RICHIESTE E RISPOSTE ====================
     
     /**
-     * @brief Gestisce la richiesta del client tramite il server
-     * @param server Riferimento al server che elabora la richiesta
-     * 
-     * Delega al server:
-     * - Routing della richiesta
-     * - Elaborazione business logic
-     * - Generazione della risposta
-     * - Gestione errori
-     */
-    void handleRequest(class Server& server);
-
-    /**
-     * @brief Legge dati dal socket del client
-     * @return Stringa contenente i dati letti
-     * @throws std::exception se errore di lettura
-     * 
-     * Operazioni:
-     * - Lettura non-bloccante dal socket
-     * - Gestione errori di rete
-     * - Rilevamento disconnessioni
-     */
-    std::string readData();
-    
-    /**
-     * @brief Prepara una risposta per l'invio al client
-     * @param content Contenuto della risposta da inviare
+     * @brief Accoda una risposta HTTP per l'invio
+     * @param response Risposta completa: blocco header e body diventano
+     *        segmenti separati della coda, senza concatenarli
      * 
-     * Operazioni:
-     * - Formattazione risposta HTTP
-     * - Aggiunta header appropriati
-     * - Buffering per invio asincrono
+     * L'invio effettivo avviene in send_pending_data() quando il
+     * socket diventa scrivibile.
      */
-    void prepare_response(const std::string& content);
+    void prepare_response(Response& response);
     
     /**
-     * @brief Invia i dati in attesa al client
-     * @return true se tutti i dati sono stati inviati
+     * @brief Invia i dati in attesa al client (una sola scrittura)
+     * @return false se la scrittura è fallita e il client va rimosso
      * 
      * Gestisce:
      * - Invio non-bloccante
-     * - Invio parziale (EAGAIN/EWOULDBLOCK)
+     * - Invio parziale: il resto rimane in coda per il prossimo EVENT_WRITE
      * - Gestione errori di rete
-     * - Aggiornamento buffer pending_data
      */
     bool send_pending_data();
+    
+    /** @brief true se ci sono dati in coda da inviare */
+    bool hasPendingOutput() const { return !output.empty(); }
 
     // ==================== GESTIONE DATI ====================
     
@@ -0,0 +1,95 @@
+/**
+ * @file ClientTable.hpp
+ * @brief Tabella dei client connessi indicizzata per file descriptor
+ *
+ * I file descriptor sono interi piccoli e densi: il Client di un fd sta
+ * nello slot con lo stesso indice e trovarlo costa un accesso a un
+ * vettore, senza alberi né confronti. Gli slot sono raggruppati in
+ * pagine da PAGE_SIZE allocate alla prima connessione che ne ha bisogno
+ * e mai spostate: i riferimenti a un Client restano validi finché la
+ * connessione è aperta, anche se la tabella cresce.
+ *
+ * Il Client viene costruito direttamente nello slot da open() e
+ * distrutto da close(); lo slot viene poi riusato dal prossimo accept()
+ * che riceve lo stesso fd. Ogni open() incrementa il contatore di
+ * generazione dello slot, così chi conserva un fd oltre la vita di una
+ * connessione può accorgersi che nel frattempo è stato riassegnato.
+ */
+
+#ifndef CLIENTTABLE_HPP
+#define CLIENTTABLE_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "Client.hpp"
+
+class ClientTable {
+public:
+    /** @brief Slot per pagina */
+    static const size_t PAGE_SIZE = 256;
+
+    ClientTable();
+
+    /** @brief Distrugge i client ancora presenti e libera le pagine */
+    ~ClientTable();
+
+    /**
+     * @brief Costruisce il client di un fd nel suo slot
+     * @param fd File descriptor appena accettato (non deve avere già un client)
+     * @return Riferimento al nuovo client, stabile fino a close()
+     */
+    Client& open(int fd);
+
+    /** @brief Distrugge il client di un fd (nessun effetto se non c'è) */
+    void close(int fd);
+
+    /** @brief Client di un fd, NULL se l'fd non ha un client */
+    Client* find(int fd) {
+        return (fd >= 0 && static_cast<size_t>(fd) < _slots.size() && _slots[fd].live)
+               ? page(fd) + fd % PAGE_SIZE : NULL;
+    }
+
+    /**
+     * @brief Client di un fd solo se appartiene ancora alla stessa connessione
+     * @param generation Valore di generation() letto quando il client era aperto
+     */
+    Client* find(int fd, unsigned generation) {
+        Client* client = find(fd);
+        return (client && _slots[fd].generation == generation) ? client : NULL;
+    }
+
+    /** @brief Generazione corrente dello slot di un fd (0 se mai usato) */
+    unsigned generation(int fd) const {
+        return (fd >= 0 && static_cast<size_t>(fd) < _slots.size()) ? _slots[fd].generation : 0;
+    }
+
+    /** @brief Limite superiore (escluso) degli fd con un client, per le scansioni */
+    int limit() const { return static_cast<int>(_slots.size()); }
+
+    /** @brief Numero di client aperti */
+    size_t size() const { return _count; }
+
+    /** @brief Byte occupati da slot e pagine (aperti o liberi) */
+    size_t memoryUsed() const;
+
+    /** @brief Distrugge tutti i client e libera le pagine */
+    void clear();
+
+private:
+    struct Slot {
+        unsigned    generation;
+        bool        live;
+    };
+
+    std::vector<Slot>       _slots;     ///< Stato degli slot, indicizzato per fd
+    std::vector<Client*>    _pages;     ///< Memoria grezza per PAGE_SIZE client ciascuna
+    size_t                  _count;
+
+    // Possiede la memoria delle pagine: non copiabile
+    ClientTable(const ClientTable&);
+    ClientTable& operator=(const ClientTable&);
+
+    Client* page(int fd) const { return _pages[fd / PAGE_SIZE]; }
+};
+
+#endif // CLIENTTABLE_HPP
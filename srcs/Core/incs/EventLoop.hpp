@@ -0,0 +1,129 @@
+/**
+ * @file EventLoop.hpp
+ * @brief Astrazione del multiplexing I/O con backend intercambiabili
+ *
+ * Il server registra ogni file descriptor (socket di ascolto e client)
+ * una sola volta; wait() restituisce soltanto i descrittori pronti,
+ * senza copiare né scansionare l'intero insieme ad ogni iterazione.
+ *
+ * Backend disponibili:
+ * - epoll (Linux): costo per wakeup proporzionale ai soli fd pronti
+ * - poll: fallback portabile, con indice fd -> posizione per add/remove O(1)
+ */
+
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include "../../../incs/webserv.hpp"
+
+// ==================== EVENTI ====================
+
+/** @brief Il descrittore è leggibile (o un listener ha connessioni in coda) */
+#define EVENT_READ  0x01
+/** @brief Il descrittore è scrivibile */
+#define EVENT_WRITE 0x02
+/** @brief Errore o chiusura lato peer (POLLERR/POLLHUP/POLLNVAL) */
+#define EVENT_ERROR 0x04
+
+/**
+ * @brief Evento restituito da EventLoop::wait()
+ */
+struct ReadyEvent {
+    int fd;
+    int events;
+};
+
+// ==================== INTERFACCIA ====================
+
+/**
+ * @brief Interfaccia comune a tutti i backend di polling
+ *
+ * Un solo EventLoop per processo: il loop principale del server
+ * chiama wait() e smista gli eventi tramite la tabella indicizzata per fd.
+ */
+class EventLoop {
+public:
+    virtual ~EventLoop() {}
+
+    /** @brief Registra un fd con la maschera di eventi indicata */
+    virtual void add(int fd, int events) = 0;
+
+    /** @brief Cambia la maschera di eventi di un fd già registrato */
+    virtual void modify(int fd, int events) = 0;
+
+    /** @brief Rimuove un fd dal monitoraggio (da chiamare prima di close()) */
+    virtual void remove(int fd) = 0;
+
+    /**
+     * @brief Attende eventi sui descrittori registrati
+     * @param ready Vettore riempito con i soli fd pronti
+     * @param timeout_ms Timeout in millisecondi (-1 = infinito)
+     * @return Numero di eventi pronti, -1 in caso di errore
+     */
+    virtual int wait(std::vector<ReadyEvent>& ready, int timeout_ms) = 0;
+
+    /** @brief Nome del backend (per log e diagnostica) */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Crea il backend richiesto
+     * @param backend "epoll", "poll" o stringa vuota per il default di piattaforma
+     * @throws std::runtime_error se il backend non è disponibile
+     */
+    static EventLoop* create(const std::string& backend);
+};
+
+// ==================== BACKEND POLL ====================
+
+/**
+ * @brief Backend basato su poll(), disponibile ovunque
+ *
+ * Mantiene il vettore pollfd persistente (nessuna copia per iterazione)
+ * e un indice fd -> posizione per modify/remove in tempo costante.
+ */
+class PollEventLoop : public EventLoop {
+private:
+    std::vector<struct pollfd> _fds;
+    std::vector<int>           _index;
+
+public:
+    PollEventLoop();
+    virtual ~PollEventLoop();
+
+    virtual void add(int fd, int events);
+    virtual void modify(int fd, int events);
+    virtual void remove(int fd);
+    virtual int wait(std::vector<ReadyEvent>& ready, int timeout_ms);
+    virtual const char* name() const { return "poll"; }
+};
+
+// ==================== BACKEND EPOLL ====================
+
+#ifdef __linux__
+
+/**
+ * @brief Backend basato su epoll (solo Linux)
+ *
+ * I descrittori restano registrati nel kernel: epoll_wait()
+ * restituisce direttamente gli fd pronti.
+ */
+class EpollEventLoop : public EventLoop {
+private:
+    int                              _epfd;
+    size_t                           _registered;
+    std::vector<struct epoll_event>  _events;
+
+public:
+    EpollEventLoop();
+    virtual ~EpollEventLoop();
+
+    virtual void add(int fd, int events);
+    virtual void modify(int fd, int events);
+    virtual void remove(int fd);
+    virtual int wait(std::vector<ReadyEvent>& ready, int timeout_ms);
+    virtual const char* name() const { return "epoll"; }
+};
+
+#endif // __linux__
+
+#endif // EVENTLOOP_HPP
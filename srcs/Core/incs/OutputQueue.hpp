@@ -0,0 +1,134 @@
+/**
+ * @file OutputQueue.hpp
+ * @brief Coda dei dati in uscita verso un client
+ *
+ * Gli handler non scrivono più direttamente sul socket: accodano i
+ * buffer della risposta e il loop principale li scarica quando il
+ * socket diventa scrivibile (EVENT_WRITE armato solo finché la coda
+ * non è vuota). Le scritture parziali riprendono dall'offset salvato,
+ * quindi le risposte grandi non vengono più troncate.
+ *
+ * I file statici vengono accodati come segmenti (fd, offset, lunghezza)
+ * e inviati con sendfile(): il contenuto non passa mai in memoria utente.
+ *
+ * Con il pipelining più risposte possono essere in coda: l'ultimo
+ * segmento di ciascuna è marcato, così il server sa quante risposte
+ * restano da inviare e può sospendere la lettura oltre pipeline_depth.
+ */
+
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "../../Utils/incs/OpenFileCache.hpp"
+#include "../../Utils/incs/SharedBuffer.hpp"
+
+/**
+ * @brief Segmento della coda: un buffer in memoria oppure una porzione di file
+ *
+ * Se file_fd != -1 il segmento è una porzione di file [file_offset,
+ * file_offset + file_remaining). Il descrittore appartiene alla coda,
+ * oppure è un riferimento preso da file_cache e va rilasciato lì.
+ * Se shared != NULL i byte stanno in un buffer condiviso (cache delle
+ * risposte) su cui il segmento tiene un riferimento.
+ */
+struct OutputSegment {
+    std::string data;
+    size_t      offset;
+    int         file_fd;
+    off_t       file_offset;
+    size_t      file_remaining;
+    OpenFileCache* file_cache;
+    SharedBuffer* shared;
+    bool        end_of_response;
+
+    OutputSegment() : data(), offset(0), file_fd(-1), file_offset(0), file_remaining(0),
+                      file_cache(NULL), shared(NULL), end_of_response(false) {}
+
+    bool isFile() const { return file_fd != -1; }
+
+    /** @brief Byte in memoria del segmento (propri o condivisi) */
+    const std::string& buffer() const { return shared ? shared->data : data; }
+};
+
+/**
+ * @brief Coda FIFO di segmenti da inviare su un socket non bloccante
+ */
+class OutputQueue {
+private:
+    /** @brief Numero massimo di segmenti raccolti in una singola scrittura */
+    static const size_t MAX_IOV = 16;
+
+    /** @brief Byte di file inviati al massimo per evento di scrittura */
+    static const size_t FILE_CHUNK = 1024 * 1024;
+
+    /** @brief Capacità massima di un buffer inviato conservato per il riuso */
+    static const size_t SPARE_MAX = 1024;
+
+    ssize_t writeBuffers(int fd);
+    ssize_t writeFile(int fd);
+
+    void popFront();
+    static void releaseSegment(const OutputSegment& segment);
+
+    std::deque<OutputSegment> _segments;
+    std::string               _spare;       ///< Buffer di un segmento già inviato, riusato dalla push successiva
+    size_t                    _pending;
+    size_t                    _responses;
+
+public:
+    OutputQueue();
+
+    /** @brief Accoda una copia dei dati (ignorata se vuota) */
+    void push(const std::string& data);
+
+    /** @brief Accoda una copia di length byte (ignorata se length == 0) */
+    void push(const char* data, size_t length);
+
+    /** @brief Accoda una copia di ogni elemento, un segmento ciascuno (es. da Response::gather()) */
+    void push(const struct iovec* iov, size_t count);
+
+    /** @brief Accoda un buffer condiviso senza copiarlo (prende un riferimento) */
+    void push(SharedBuffer* buffer);
+
+    /**
+     * @brief Accoda una porzione di file da inviare con sendfile()
+     * @param file_fd Descrittore aperto in lettura
+     * @param offset Offset di partenza nel file
+     * @param length Numero di byte da inviare
+     * @param cache Cache da cui è stato preso l'fd (NULL: la coda lo chiude)
+     */
+    void pushFile(int file_fd, off_t offset, size_t length, OpenFileCache* cache = NULL);
+
+    /** @brief Marca l'ultimo segmento accodato come fine di una risposta */
+    void markResponseEnd();
+
+    /** @brief Risposte complete accodate e non ancora inviate del tutto */
+    size_t pendingResponses() const { return _responses; }
+
+    /** @brief true se non ci sono dati da inviare */
+    bool empty() const { return _segments.empty(); }
+
+    /** @brief Byte ancora da inviare */
+    size_t pendingBytes() const { return _pending; }
+
+    /**
+     * @brief Esegue UNA scrittura (scatter/gather) sul socket
+     * @param fd Socket del client
+     * @return Byte inviati (0 se la coda è vuota), -1 se il client va rimosso
+     */
+    ssize_t writeTo(int fd);
+
+    /**
+     * @brief Scarta tutti i dati in coda e chiude i file accodati
+     *
+     * Non viene chiamata dal distruttore: Server::removeClient() e
+     * Server::cleanup() la chiamano prima che ClientTable::close() o
+     * ClientTable::clear() distruggano il client nel suo slot, quando la
+     * OpenFileCache a cui restituire gli fd accodati è ancora valida.
+     */
+    void clear();
+};
+
+#endif // OUTPUTQUEUE_HPP
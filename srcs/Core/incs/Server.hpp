@@ -39,10 +39,51 @@
 #include "../../Config/incs/LocationConfig.hpp"
 
 #include "Client.hpp"
+#include "ClientTable.hpp"
+#include "EventLoop.hpp"
 
 #include "../../HTTP/incs/Request.hpp"
 #include "../../HTTP/incs/Response.hpp"
 
+#include "../../Utils/incs/OpenFileCache.hpp"
+#include "../../Utils/incs/BufferPool.hpp"
+#include "../../HTTP/incs/ResponseCache.hpp"
+
+#include "../../CGI/incs/CGIProcess.hpp"
+#include "../../HTTP/incs/DirectoryListing.hpp"
+#include "TimerWheel.hpp"
+#include "../../CGI/incs/FastCGIPool.hpp"
+#include "../../CGI/incs/CGIWorkerPool.hpp"
+
+// ==================== TABELLA DI DISPATCH ====================
+
+/** @brief Tipo di descrittore registrato nel loop degli eventi */
+enum FdType {
+    FD_NONE,
+    FD_LISTENER,
+    FD_CLIENT,
+    FD_CGI_IN,      ///< Pipe verso lo stdin di uno script CGI
+    FD_CGI_OUT,     ///< Pipe dallo stdout di uno script CGI
+    FD_FASTCGI,     ///< Connessione FastCGI con una richiesta in corso
+    FD_FASTCGI_IDLE,///< Connessione FastCGI libera nel pool
+    FD_CGI_WORKER   ///< Socket di un worker di cgi_pool (peer -1 se libero)
+};
+
+/**
+ * @brief Voce della tabella fd -> proprietario
+ *
+ * Permette di smistare un evento con un singolo accesso per indice,
+ * invece di scansionare la lista dei server ad ogni fd pronto.
+ */
+struct FdEntry {
+    FdType  type;
+    Server* server;
+    int     events;     ///< Maschera attualmente registrata nel loop
+    int     peer;       ///< Per pipe CGI e connessioni FastCGI: fd del client servito
+
+    FdEntry() : type(FD_NONE), server(NULL), events(0), peer(-1) {}
+};
+
 // ==================== CLASSE SERVER ====================
 
 /**
@@ -64,11 +105,44 @@ private:
     /** @brief Lista di tutti i server attivi nel sistema */
     static std::vector<Server*>      servers;
     
-    /** @brief File descriptors per il polling I/O */
-    static std::vector<struct pollfd> poll_fds;
+    /** @brief Backend di multiplexing I/O (epoll o poll) */
+    static EventLoop*                loop;
+    
+    /** @brief Tabella di dispatch indicizzata per fd (listener o client) */
+    static std::vector<FdEntry>      fd_table;
+    
+    /** @brief Fd da chiudere a fine iterazione (evita riuso nello stesso batch) */
+    static std::vector<int>          pending_close;
     
-    /** @brief Mappa dei client connessi (fd -> Client) */
-    static std::map<int, Client>      clients;
+    /** @brief Client connessi, in slot indicizzati per fd */
+    static ClientTable               clients;
+
+    /** @brief Buffer riusati per i recv() dai client */
+    static BufferPool                buffers;
+    
+    /** @brief Cache di fd e metadati dei file statici (una per processo) */
+    static OpenFileCache             file_cache;
+
+    /** @brief Risposte in memoria dei file statici piccoli (una per processo) */
+    static ResponseCache             response_cache;
+
+    /** @brief Script CGI in esecuzione (fd del client -> processo) */
+    static std::map<int, CGIProcess*> cgi_processes;
+
+    /** @brief Script CGI terminati o uccisi non ancora raccolti con waitpid() */
+    static std::vector<pid_t>        cgi_zombies;
+
+    /** @brief Connessioni persistenti verso i backend fastcgi_pass */
+    static FastCGIPool               fastcgi_pool;
+
+    /** @brief Interpreti persistenti delle location con cgi_pool */
+    static CGIWorkerPool             cgi_workers;
+
+    /** @brief Client in attesa di un worker libero (ordine di arrivo) */
+    static std::deque<int>           cgi_waiting;
+
+    /** @brief Scadenze delle connessioni client (indicizzate per fd) */
+    static TimerWheel                timers;
 
     // ==================== MEMBRI DI ISTANZA ====================
     
@@ -96,6 +170,27 @@ private:
      */
     void setupSocket();
     
+    /**
+     * @brief Crea un nuovo socket in ascolto sulla porta configurata
+     * @return File descriptor del socket (SO_REUSEPORT se worker_processes > 1)
+     * @throws std::runtime_error se fallisce la creazione/configurazione
+     */
+    int openListenSocket();
+    
+    /** @brief Sostituisce (o chiude, con -1) il socket in ascolto del server */
+    void replaceListenSocket(int fd);
+    
+    // ==================== MODALITÀ MULTI-PROCESSO ====================
+    
+    /** @brief Loop degli eventi del processo corrente (singolo o worker) */
+    static void eventLoop();
+    
+    /** @brief Master: avvia e supervisiona i worker, riavviando quelli terminati */
+    static void superviseWorkers(int count);
+    
+    /** @brief Forka un worker con socket propri; ritorna il PID del figlio */
+    static pid_t spawnWorker(int index);
+    
     // ==================== GESTORI RICHIESTE HTTP ====================
     
     /** @brief Gestisce richieste GET (lettura file, directory listing) */
@@ -110,6 +205,81 @@ private:
     
     void handleCgiRequest(Client* client, const LocationConfig& location);
     
+    // ==================== CGI NEL LOOP DEGLI EVENTI ====================
+    
+    /** @brief Scrive (una volta) il body della richiesta nella pipe di input */
+    static void handleCgiInput(int pipe_fd);
+    
+    /** @brief Legge (una volta) l'output dello script e lo accoda al client */
+    static void handleCgiOutput(int pipe_fd);
+    
+    /** @brief Completa la risposta all'EOF dello script e riprende la pipeline */
+    static void finishCgi(CGIProcess* process);
+    
+    /**
+     * @brief Rimuove le pipe e libera il processo
+     * @param kill_child true per terminare lo script (timeout, client chiuso)
+     */
+    static void releaseCgi(CGIProcess* process, bool kill_child);
+    
+    /** @brief Chiude la pipe di input (body scritto o script che non legge) */
+    static void closeCgiInput(CGIProcess* process);
+    
+    /** @brief Risponde 504 (o chiude) per gli script oltre la scadenza */
+    static void checkCgiTimeouts();
+    
+    /** @brief Raccoglie senza bloccare gli script già terminati */
+    static void reapCgiZombies();
+    
+    /** @brief Timeout per EventLoop::wait(): fino alla prossima scadenza CGI */
+    static int cgiWaitTimeout();
+    
+    /** @brief Sospende la lettura dell'output finché il client non smaltisce la coda */
+    static void throttleCgiOutput(CGIProcess* process);
+    
+    // ==================== FASTCGI ====================
+    
+    /** @brief Invia la richiesta al backend fastcgi_pass della location */
+    void handleFastCgiRequest(Client* client, const LocationConfig& location);
+    
+    /** @brief Invio dei record o lettura della risposta (una operazione per evento) */
+    static void handleFastCgiEvent(int fd, int events);
+    
+    /** @brief Collega al processo una connessione presa dal pool */
+    static void attachFastCgiConnection(CGIProcess* process);
+    
+    /**
+     * @brief Riprova su una connessione nuova se quella del pool era stata chiusa
+     * @return false se la richiesta va considerata fallita
+     */
+    static bool retryFastCgi(CGIProcess* process);
+    
+    /** @brief Rimette nel pool (o chiude) la connessione di una richiesta conclusa */
+    static void parkFastCgiConnection(CGIProcess* process);
+    
+    // ==================== CGI_POOL ====================
+    
+    /** @brief Assegna la richiesta a un worker persistente (o la mette in attesa) */
+    void handlePooledCgiRequest(Client* client, CGIExecutor& cgi);
+    
+    /** @brief Invio della richiesta o lettura dei blocchi di risposta (una operazione per evento) */
+    static void handleCgiWorkerEvent(int fd, int events);
+    
+    /** @brief Collega il socket di un worker alla richiesta */
+    static void attachCgiWorker(CGIProcess* process, int fd);
+    
+    /** @brief Rimette libero il worker di una richiesta conclusa (o lo ricicla) */
+    static void parkCgiWorker(CGIProcess* process);
+    
+    /**
+     * @brief Toglie un worker dal pool e ne chiude il socket
+     * @param kill_worker true per terminarlo subito (timeout, risposta interrotta)
+     */
+    static void retireCgiWorker(int fd, bool kill_worker);
+    
+    /** @brief Assegna i worker liberati alle richieste in attesa */
+    static void dispatchWaitingCgi();
+    
     /** @brief Gestisce richieste POST (upload file, form data) */
     void handlePostRequest(Client* client);
     
@@ -119,6 +289,9 @@ private:
     /** @brief Gestisce richieste OPTIONS (CORS, metodi supportati) */
     void handleOptionsRequest(Client* client);
     
+    /** @brief Risponde con le statistiche del processo (location "stub_status") */
+    void sendStatusResponse(Client* client);
+    
     // ==================== OPERAZIONI FILE E DIRECTORY ====================
     
     /**
@@ -135,6 +308,12 @@ private:
      * @param path Percorso della directory
      */
     void handleDirectoryListing(Client* client, const std::string& path);
+
+    /**
+     * @brief Accoda pezzi dell'autoindex finché la coda del client lo consente
+     * @return true se la pagina è stata completata (listing liberato)
+     */
+    static bool streamListing(Client& client);
     
     /**
      * @brief Verifica se una richiesta deve essere gestita da CGI
@@ -146,22 +325,52 @@ private:
     
     /**
      * @brief Analizza body multipart per upload file
-     * @param body Contenuto del body HTTP
+     * @param body Contenuto del body HTTP (in memoria o file mappato)
+     * @param size Dimensione del body
      * @param boundary Boundary per separare le parti
      * @param uploadDir Directory dove salvare i file
      */
-    void parseMultipartBody(const std::string& body, const std::string& boundary, const std::string& uploadDir);
+    void parseMultipartBody(const char* body, size_t size, const std::string& boundary, const std::string& uploadDir);
+
+    /**
+     * @brief Conclude un upload il cui body è già su disco
+     * @param client Client con il body completo
+     * @param uploadDir Directory di destinazione
+     *
+     * Il body binario diventa il file caricato con un rename(); le parti
+     * di un multipart sono già state salvate da MultipartUpload.
+     */
+    void handleSpooledUpload(Client* client, const std::string& uploadDir);
+
+    /**
+     * @brief Scarta dalle cache un file appena creato o cancellato
+     * @param path Percorso nella stessa forma delle chiavi (root o upload_dir + URI)
+     *
+     * Le altre entry restano valide: un POST verso un CGI o una DELETE
+     * fallita non toccano le cache.
+     */
+    static void invalidateCachedPath(const std::string& path);
+
+    /** @brief Scarta dalle cache i file salvati da un upload multipart */
+    static void invalidateUploads(const MultipartUpload& upload);
     
     // ==================== GESTIONE POLLING ====================
     
-    /** @brief Aggiunge un file descriptor al polling */
-    static void addPollFD(int fd, short events);
+    /**
+     * @brief Registra un fd nel loop degli eventi e nella tabella di dispatch
+     * @param fd File descriptor da monitorare
+     * @param type Tipo di descrittore (listener o client)
+     * @param owner Server proprietario (per i listener)
+     * @param events Maschera EVENT_READ / EVENT_WRITE
+     * @param peer Client servito (solo per le pipe CGI)
+     */
+    static void registerFd(int fd, FdType type, Server* owner, int events, int peer = -1);
     
-    /** @brief Rimuove un file descriptor dal polling */
-    static void removePollFD(int fd);
+    /** @brief Rimuove un fd dal loop degli eventi e dalla tabella di dispatch */
+    static void unregisterFd(int fd);
     
-    /** @brief Verifica se un fd appartiene a un server */
-    bool isServerFD(int fd) const;
+    /** @brief Chiude gli fd rimossi durante l'iterazione corrente */
+    static void flushPendingClose();
     
     // ==================== GESTIONE ERRORI ====================
     
@@ -173,12 +382,49 @@ private:
     std::string getErrorPage(int errorCode) const;
     
     /**
-     * @brief Invia dati in modo sicuro gestendo errori senza errno
+     * @brief Accoda una risposta nella coda di output del client
      * @param client Client destinatario
-     * @param data Dati da inviare
-     * @return true se invio riuscito, false se client deve essere rimosso
+     * @param response Risposta completa: blocco header e body vanno in
+     *        segmenti separati, inviati insieme da una sendmsg()
+     * 
+     * EVENT_WRITE viene armato da updateClientEvents() al termine
+     * dell'elaborazione. Gli errori di scrittura vengono gestiti da
+     * handleClientWrite(), che rimuove il client senza consultare errno.
+     */
+    static void queueResponse(Client* client, Response& response);
+    
+    /**
+     * @brief Invia parte della coda di output quando il socket è scrivibile
+     * @param client_fd File descriptor del client
+     */
+    static void handleClientWrite(int client_fd);
+    
+    /**
+     * @brief Elabora in ordine le richieste complete nel buffer (pipelining)
+     * @param client_fd File descriptor del client
+     */
+    static void processPipeline(int client_fd);
+
+    /** @brief Apre il BodySink se la richiesta è un upload da scrivere su disco */
+    static bool spoolUpload(Client& client);
+    
+    /** @brief Ricalcola gli eventi di un client (o lo chiude a coda vuota) */
+    static void updateClientEvents(int client_fd);
+
+    /**
+     * @brief Arma la scadenza che corrisponde allo stato del client
+     *
+     * - header in arrivo: client_header_timeout, dal primo byte della
+     *   richiesta (non riarmato a ogni lettura: un client lento non lo proroga)
+     * - body in arrivo: client_body_timeout tra due letture
+     * - output in coda: send_timeout tra due scritture
+     * - connessione inattiva dopo una risposta: keepalive_timeout
+     * - risposta in produzione (CGI, autoindex): nessuna, vale la scadenza CGI
      */
-    static bool safeSend(Client* client, const std::string& data);
+    static void armClientTimer(Client& client);
+
+    /** @brief Chiude (o risponde 408 a) i client la cui scadenza è passata */
+    static void handleClientTimeouts();
 
 public:
     // ==================== COSTRUTTORE E DISTRUTTORE ====================
@@ -200,16 +446,17 @@ public:
     /** @brief Restituisce il file descriptor del server */
     int getServerFd() const;
     
-    /** @brief Restituisce la lista dei file descriptors per polling */
-    const std::vector<struct pollfd>& getPollFds() const;
+    /** @brief Restituisce la configurazione di questo server */
+    const ServerConfig& getConfig() const;
     
     // ==================== OPERAZIONI PRINCIPALI ====================
     
     /**
      * @brief Loop principale del server
      * 
-     * Esegue il ciclo infinito di:
-     * 1. Polling per eventi I/O
+     * Con worker_processes > 1 il processo diventa master e delega
+     * il ciclo ai worker; altrimenti esegue il ciclo infinito di:
+     * 1. Attesa eventi I/O tramite il backend configurato (epoll/poll)
      * 2. Accettazione nuove connessioni
      * 3. Lettura richieste client
      * 4. Elaborazione e risposta
@@ -225,8 +472,10 @@ public:
     // ==================== GESTIONE CLIENT ====================
     
     /**
-     * @brief Accetta una nuova connessione client
-     * @throws std::runtime_error se fallisce l'accettazione
+     * @brief Accetta le connessioni in coda sul listener
+     *
+     * Fino a accept_budget connessioni per evento, ciascuna con una sola
+     * accept4() (già non bloccante); si ferma prima se la coda è vuota.
      */
     void acceptNewConnection();
     
@@ -252,18 +501,11 @@ public:
     void sendResponse(Client* client, int status, const std::string& content);
     
     /**
-     * @brief Modifica gli eventi di polling per un client
-     * @param index Indice nel vettore poll_fds
-     * @param events Nuovi eventi da monitorare
+     * @brief Modifica gli eventi monitorati per un fd registrato
+     * @param fd File descriptor del client
+     * @param events Nuova maschera EVENT_READ / EVENT_WRITE
      */
-    void setPollEvents(size_t index, short events);
-    
-    /**
-     * @brief Gestisce una richiesta HTTP
-     * @param request Richiesta da elaborare
-     * @param response Risposta da generare
-     */
-    void handleRequest(const Request& request, Response& response);
+    static void setEvents(int fd, int events);
     
     /**
      * @brief Elabora una richiesta di un client
@@ -285,6 +527,9 @@ public:
      * @param config Configurazione del server per pagine di errore personalizzate
      */
     static void sendErrorResponse(Client* client, int statusCode, const std::string& message, const ServerConfig& config);
+
+    /** @brief Connection e Keep-Alive (con il keepalive_timeout configurato) */
+    static void addConnectionHeaders(Client* client, Response& response);
     
     /**
      * @brief Invia risposta "Method Not Allowed"
@@ -0,0 +1,91 @@
+/**
+ * @file TimerWheel.hpp
+ * @brief Timer gerarchico per le scadenze delle connessioni
+ *
+ * Ogni timer è identificato da un intero piccolo (il file descriptor
+ * del client) e vive in una lista doppiamente collegata intrusiva dentro
+ * un vettore indicizzato per id: arm() e cancel() costano O(1) e non
+ * allocano memoria, qualunque sia il numero di connessioni.
+ *
+ * Le scadenze sono in tick da TICK_MS. Il primo livello ha uno slot per
+ * tick; i livelli superiori coprono intervalli 64 volte più grandi e i
+ * loro slot vengono redistribuiti sul livello sotto quando il livello
+ * inferiore completa un giro. Un timer viene quindi spostato al più una
+ * volta per livello prima di scadere.
+ *
+ * nextTimeout() dà al loop degli eventi il timeout di poll()/epoll_wait():
+ * il loop dorme fino alla prossima scadenza invece di svegliarsi a
+ * intervalli fissi.
+ *
+ * Il tempo è quello di Clock, aggiornato una volta per iterazione: un
+ * timer può scadere in ritardo al più della durata di un'iterazione,
+ * mai in anticipo.
+ */
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class TimerWheel {
+public:
+    /** @brief Risoluzione del timer in millisecondi */
+    static const unsigned long TICK_MS = 100;
+
+    TimerWheel();
+
+    /**
+     * @brief Arma (o riarma) il timer di un id
+     * @param id Identificatore non negativo (file descriptor)
+     * @param delay_ms Ritardo dalla chiamata; la scadenza è arrotondata al tick successivo
+     */
+    void arm(int id, unsigned long delay_ms);
+
+    /** @brief Disarma il timer di un id (nessun effetto se non è armato) */
+    void cancel(int id);
+
+    /** @brief true se il timer dell'id è armato */
+    bool armed(int id) const;
+
+    /**
+     * @brief Porta avanti il tempo e raccoglie i timer scaduti
+     * @param expired Riempito con gli id scaduti (già disarmati)
+     */
+    void advance(std::vector<int>& expired);
+
+    /**
+     * @brief Millisecondi fino alla prossima scadenza, per il timeout del loop
+     * @return -1 se nessun timer è armato
+     *
+     * Con timer solo nei livelli superiori restituisce il momento della
+     * loro redistribuzione: il loop si sveglia al più qualche volta in più.
+     */
+    int nextTimeout() const;
+
+    /** @brief Numero di timer armati */
+    size_t size() const { return _count; }
+
+private:
+    static const int    LEVELS = 4;
+    static const int    LEVEL_BITS = 6;
+    static const size_t SLOTS = 1 << LEVEL_BITS;    ///< Slot per livello (64)
+
+    struct Node {
+        int             prev;
+        int             next;
+        unsigned long   expires;    ///< Tick di scadenza
+        int             slot;       ///< Indice in _heads, -1 se non armato
+    };
+
+    std::vector<Node>   _nodes;     ///< Indicizzato per id
+    std::vector<int>    _heads;     ///< LEVELS * SLOTS teste di lista (-1 = vuota)
+    unsigned long       _tick;      ///< Ultimo tick elaborato
+    size_t              _count;
+
+    void insert(int id);
+    void unlink(int id);
+    void cascade(int level);
+    static unsigned long toTick(unsigned long ms);
+};
+
+#endif // TIMERWHEEL_HPP
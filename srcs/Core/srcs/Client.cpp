@@ -20,86 +20,12 @@
 
 #include "../../Config/incs/ServerConfig.hpp"
 
-// ==================== IMPLEMENTAZIONE METODI HELPER PRIVATI ====================
-
-/**
- * @brief Estrae il Content-Length dagli header HTTP
- * @param headers Stringa contenente gli header HTTP
- * @return Dimensione del body in bytes, 0 se non specificata
- * 
- * REFACTORING: Estratta da isRequestComplete() per migliorare leggibilità
- * e riutilizzabilità del codice
- */
-size_t Client::extractContentLength(const std::string& headers) const {
-    size_t pos = headers.find("Content-Length:");
-    if (pos == std::string::npos) {
-        return 0; // Header non trovato
-    }
-    
-    // Salta il ":" e gli spazi bianchi
-    pos = headers.find(':', pos) + 1;
-    while (pos < headers.size() && isspace(headers[pos])) {
-        pos++;
-    }
-    
-    // Trova la fine del numero (fino al primo non-digit)
-    size_t end = pos;
-    while (end < headers.size() && isdigit(headers[end])) {
-        end++;
-    }
-    
-    // Se non ci sono cifre, ritorna 0
-    if (pos == end) {
-        return 0;
-    }
-    
-    // Converte la sottostringa in numero
-    return static_cast<size_t>(atoi(headers.substr(pos, end - pos).c_str()));
-}
-
-/**
- * @brief Verifica se la richiesta è di tipo GET o HEAD (senza body)
- * @return true se la richiesta non dovrebbe avere un body
- * 
- * REFACTORING: Estratta da isRequestComplete() per semplificare la logica
- * e migliorare la leggibilità del codice principale
- */
-bool Client::isMethodWithoutBody() const {
-    std::string method_line = request_data.substr(0, request_data.find(HTTP_LINE_SEPARATOR));
-    return (method_line.find("GET") == 0 || method_line.find("HEAD") == 0);
-}
-
-/**
- * @brief Valida la dimensione del body contro i limiti configurati
- * @param content_length Dimensione dichiarata del body
- * @param body_received Dimensione effettiva ricevuta
- * @throws std::runtime_error se il body è troppo grande
- * 
- * REFACTORING: Estratta da isRequestComplete() per centralizzare i controlli
- * di sicurezza e migliorare la manutenibilità
- */
-void Client::validateBodySize(size_t content_length, size_t body_received) const {
-    // Controlla Content-Length dichiarato
-    if (content_length > DEFAULT_MAX_BODY_SIZE) {
-        std::cerr << "ERROR: Content-Length exceeds max body size: " << content_length 
-                 << " bytes (max: " << DEFAULT_MAX_BODY_SIZE << " bytes)" << std::endl;
-        throw std::runtime_error("REQUEST_ENTITY_TOO_LARGE");
-    }
-    
-    // Controlla dati effettivamente ricevuti
-    if (body_received > DEFAULT_MAX_BODY_SIZE) {
-        std::cerr << "ERROR: Received body exceeds max body size: " << body_received 
-                 << " bytes (max: " << DEFAULT_MAX_BODY_SIZE << " bytes)" << std::endl;
-        throw std::runtime_error("REQUEST_ENTITY_TOO_LARGE");
-    }
-}
-
 // ==================== IMPLEMENTAZIONE METODI PUBBLICI ====================
 
 // Updated parseRequest() method
 void Client::parseRequest() {
-    // Pass the raw request data to the parser
-    request.parse(request_data.c_str(), request_data.size());
+    // Gli offset sono già stati registrati da isRequestComplete()
+    request.load(request_data, parser, arena);
     
     std::cout << "Request parsed: " << request.getMethod() << " " 
             << request.getPath() << std::endl;
@@ -108,11 +34,20 @@ void Client::parseRequest() {
 
 // Fix initialization order to match declaration
 Client::Client(int client_fd) : 
-    pending_data(),
     keep_alive(false),
     fd(client_fd),
     request(),
-    request_data() {}
+    arena(),
+    request_data(),
+    parser(),
+    body(),
+    upload(),
+    output(),
+    close_after_flush(false),
+    cgi(NULL),
+    listing(NULL),
+    timer(TIMER_NONE),
+    requests_served(0) {}
 
 void Client::appendRequestData(const char* data, size_t length) {
     request_data.append(data, length);
@@ -126,160 +61,134 @@ void Client::setKeepAlive(bool value) {
     keep_alive = value;
 }
 
-void Client::handleRequest(Server& server) {
-    std::string data = readData();
-
-    if (data.empty()) {
-        server.removeClient(fd);
-        return;
-    }
-
-    try {
-        // Parse the request from accumulated data
-        request.parse(data.c_str(), data.size());
-
-        // Prepare response object
-        Response response;
-
-        // Call server logic to handle the request
-        server.handleRequest(request, response);
-
-        // Convert the response to a raw HTTP string
-        pending_data = response.generate();
-
-    } catch (const std::exception& e) {
-        std::cerr << "Request handling error: " << e.what() << "\n";
-
-        // Fallback error response
-        Response response;
-        response.setStatus(500);
-        response.setBody("500 Internal Server Error");
-        pending_data = response.generate();
-    }
+/**
+ * @brief Verifica completezza richiesta HTTP
+ * @return true se la richiesta è completa e valida
+ * @throws std::runtime_error se la richiesta è malformata o il body troppo grande
+ * 
+ * Delega a RequestParser, che esamina solo i byte arrivati dall'ultima
+ * chiamata e gestisce sia Content-Length sia Transfer-Encoding: chunked.
+ */
+bool Client::isRequestComplete() {
+    if (isSpooling() && !parser.isComplete())
+        return spoolBody();
+    return feedParser() == RequestParser::COMPLETE;
+}
 
-    // Mark this FD as ready to write
-    const std::vector<struct pollfd>& pollfds = server.getPollFds();
-    for (size_t i = 0; i < pollfds.size(); ++i) {
-        if (pollfds[i].fd == fd) {
-            server.setPollEvents(i, POLLIN | POLLOUT);
-            break;
-        }
+/**
+ * @brief Passa al parser i nuovi byte, traducendo gli errori in eccezioni
+ */
+RequestParser::Status Client::feedParser() {
+    RequestParser::Status status = parser.feed(request_data);
+    if (status != RequestParser::ERROR)
+        return status;
+
+    switch (parser.errorCode()) {
+        case HTTP_REQUEST_ENTITY_TOO_LARGE:
+            throw std::runtime_error("REQUEST_ENTITY_TOO_LARGE");
+        case HTTP_NOT_IMPLEMENTED:
+            throw std::runtime_error("NOT_IMPLEMENTED");
+        case HTTP_VERSION_NOT_SUPPORTED:
+            throw std::runtime_error("HTTP_VERSION_NOT_SUPPORTED");
+        default:
+            throw std::runtime_error("BAD_REQUEST");
     }
 }
 
 /**
- * @brief Legge dati dal socket del client utilizzando buffer di dimensione configurabile
- * @return Stringa contenente tutti i dati ricevuti
- * @throws std::runtime_error se errore di lettura
- * 
- * REFACTORING: Sostituita costante magica 1024 con Client::BUFFER_SIZE
- * per maggiore manutenibilità e configurabilità
+ * @brief Scrive su disco il body arrivato finora e lo toglie dal buffer
+ *
+ * Dopo gli header il buffer contiene al più un recv() di body: il
+ * resto è già nel file. Eventuali byte oltre Content-Length
+ * (richiesta pipelined successiva) restano nel buffer.
+ *
+ * Con un body chunked il parser decodifica prima i byte arrivati e
+ * nel file finisce solo il body decodificato; la fine del body la
+ * stabilisce il chunk finale.
  */
-std::string Client::readData() {
-    char buffer[BUFFER_SIZE];
-    
-    // ✅ CRITICAL FIX: Only ONE read per call as required by evaluation
-    // Remove the while loop - only read once per call
-    ssize_t bytes_read = recv(fd, buffer, sizeof(buffer), 0);
-    
-    // ✅ CRITICAL FIX: Check ALL return values properly and do NOT use errno
-    if (bytes_read > 0) {
-        request_data.append(buffer, bytes_read);
-        
-        // Check for complete headers using constant
-        if (request_data.find(HTTP_HEADER_SEPARATOR) != std::string::npos) {
-            size_t headers_end = request_data.find(HTTP_HEADER_SEPARATOR);
-            std::string headers_part = request_data.substr(0, headers_end);
-
-            size_t content_length = extractContentLength(headers_part);
-
-            size_t total_length = headers_end + 4 + content_length;
-            if (request_data.size() >= total_length) {
-                // Full request including body is received
-                return request_data;
-            }
-        }
-    } else if (bytes_read == 0) {
-        // Connection closed by peer
-        throw std::runtime_error("Connection closed");
-    } else {
-        // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
-        // Any read error should be treated as connection failure
-        throw std::runtime_error("Read error");
+bool Client::spoolBody() {
+    // Scrittura fallita durante un receive() diretto dal socket
+    if (body.failed())
+        throw std::runtime_error("UPLOAD_WRITE_FAILED");
+
+    bool multipart = upload.isOpen();
+    if (parser.isChunked()) {
+        bool complete = feedParser() == RequestParser::COMPLETE;
+        writeBody(parser.bodyOffset(), parser.bodyLength());
+        parser.bodyFlushed();
+        return complete;
     }
-    
-    return request_data;
+
+    size_t start = parser.bodyOffset();
+    writeBody(start, std::min(request_data.size() - start, multipart ? upload.remaining() : body.remaining()));
+    if (multipart ? !upload.complete() : !body.complete())
+        return false;
+    parser.bodyStored();
+    return true;
 }
 
 /**
- * @brief Verifica completezza richiesta HTTP con controlli di sicurezza migliorati
- * @return true se la richiesta è completa e valida
- * @throws std::runtime_error se body troppo grande
- * 
- * REFACTORING: 
- * - Sostituita costante magica 1048576 con DEFAULT_MAX_BODY_SIZE
- * - Utilizzate costanti per separatori HTTP
- * - Estratte funzioni helper per migliorare leggibilità
- * - Semplificata logica principale
+ * @brief Sposta nel sink aperto i byte [start, start + length) del buffer
  */
-bool Client::isRequestComplete() {
-    // Verifica presenza header completi
-    size_t header_end = request_data.find(HTTP_HEADER_SEPARATOR);
-    if (header_end == std::string::npos) {
-        return false; // Headers not complete yet
-    }
-    
-    // ✅ REFACTORING: Usa helper method per verificare metodi senza body
-    if (isMethodWithoutBody()) {
-        return true;
+void Client::writeBody(size_t start, size_t length) {
+    if (length == 0)
+        return;
+    const char* data = request_data.data() + start;
+    if (upload.isOpen()) {
+        if (!upload.write(data, length))
+            throw std::runtime_error(upload.malformed() ? "BAD_REQUEST" : "UPLOAD_WRITE_FAILED");
+    } else if (!body.write(data, length)) {
+        throw std::runtime_error("UPLOAD_WRITE_FAILED");
     }
-    
-    // Estrai header e verifica Content-Length
-    std::string headers = request_data.substr(0, header_end);
-    size_t content_length = extractContentLength(headers);  // ✅ REFACTORING: Usa helper method
-    
-    if (content_length == 0) {
-        return true; // No content expected
+    request_data.erase(start, length);
+}
+
+void Client::nextRequest() {
+    size_t consumed = parser.end();
+    ++requests_served;
+    request = Request();
+    // Tutto ciò che la richiesta ha preso dall'arena torna al pool
+    arena.reset();
+    // Upload non confermato dall'handler (errore, 4xx): i file temporanei spariscono
+    body.discard();
+    upload.discard();
+
+    if (consumed >= request_data.size()) {
+        // Connessione inattiva fino alla prossima richiesta: un buffer
+        // piccolo resta per la richiesta successiva (nessuna allocazione),
+        // uno cresciuto per un header o un body grande viene liberato
+        if (request_data.capacity() > IDLE_BUFFER_MAX)
+            std::string().swap(request_data);
+        else
+            request_data.clear();
+        parser.reset(0);
+    } else if (consumed >= request_data.size() / 2) {
+        // Compatta il buffer solo quando la parte consumata è maggioritaria,
+        // così una raffica di richieste piccole non sposta i byte ogni volta
+        request_data.erase(0, consumed);
+        parser.reset(0);
+    } else {
+        parser.reset(consumed);
     }
-    
-    // Calcola dimensioni body
-    size_t body_start = header_end + 4; // Skip \r\n\r\n
-    size_t body_received = request_data.size() - body_start;
-    
-    // ✅ REFACTORING: Usa helper method per validazione sicurezza
-    validateBodySize(content_length, body_received);
-    
-    std::cout << "DEBUG: Content-Length: " << content_length 
-              << ", Body received: " << body_received << " bytes" << std::endl;
-              
-    return body_received >= content_length;
 }
 
 bool Client::send_pending_data() {
-    if (pending_data.empty())
+    if (output.empty())
         return true;
 
     // ✅ CRITICAL FIX: Only ONE write per call as required by evaluation
-    ssize_t bytes_sent = write(fd, pending_data.c_str(), pending_data.size());
-    
     // ✅ CRITICAL FIX: Check ALL return values properly and do NOT use errno
-    if (bytes_sent > 0) {
-        // Remove sent data from pending buffer
-        pending_data = pending_data.substr(bytes_sent);
-        return pending_data.empty(); // Return true if all data sent
-    } else if (bytes_sent == 0) {
-        // No data was sent (shouldn't happen with write, but handle it)
-        return false;
-    } else {
-        // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
+    if (output.writeTo(fd) < 0) {
         // Any write error should be treated as connection failure
         std::cerr << "Write failed on client " << fd << std::endl;
         return false;
     }
+    // Partial writes stay queued until the next EVENT_WRITE
+    return true;
 }
 
-void Client::prepare_response(const std::string& content) {
-    // ✅ CRITICAL FIX: The content parameter is already a complete HTTP response
-    // Don't add additional headers - just store it for sending
-    pending_data = content;
-}
\ No newline at end of file
+void Client::prepare_response(Response& response) {
+    // Header e body restano due segmenti: la coda li invia con una sola sendmsg()
+    struct iovec iov[2];
+    output.push(iov, response.gather(iov));
+}
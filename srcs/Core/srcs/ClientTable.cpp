@@ -0,0 +1,56 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/ClientTable.hpp"
+
+ClientTable::ClientTable() : _slots(), _pages(), _count(0) {}
+
+ClientTable::~ClientTable() {
+    clear();
+}
+
+Client& ClientTable::open(int fd) {
+    if (static_cast<size_t>(fd) >= _slots.size()) {
+        Slot empty = { 0, false };
+        _slots.resize(fd + 1, empty);
+    }
+    // Pagina allocata solo quando serve, senza costruire i client
+    size_t index = fd / PAGE_SIZE;
+    if (index >= _pages.size())
+        _pages.resize(index + 1, NULL);
+    if (!_pages[index])
+        _pages[index] = static_cast<Client*>(::operator new(sizeof(Client) * PAGE_SIZE));
+
+    close(fd);
+    Client* client = new (page(fd) + fd % PAGE_SIZE) Client(fd);
+    _slots[fd].live = true;
+    ++_slots[fd].generation;
+    ++_count;
+    return *client;
+}
+
+void ClientTable::close(int fd) {
+    Client* client = find(fd);
+    if (!client)
+        return;
+    client->~Client();
+    _slots[fd].live = false;
+    --_count;
+}
+
+size_t ClientTable::memoryUsed() const {
+    size_t pages = 0;
+    for (size_t i = 0; i < _pages.size(); ++i)
+        if (_pages[i])
+            ++pages;
+    return _slots.capacity() * sizeof(Slot) + _pages.capacity() * sizeof(Client*)
+           + pages * PAGE_SIZE * sizeof(Client);
+}
+
+void ClientTable::clear() {
+    for (int fd = 0; fd < limit(); ++fd)
+        close(fd);
+    for (size_t i = 0; i < _pages.size(); ++i)
+        ::operator delete(_pages[i]);
+    _pages.clear();
+    _slots.clear();
+}
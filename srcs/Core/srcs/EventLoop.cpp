@@ -0,0 +1,169 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/EventLoop.hpp"
+
+// ==================== FACTORY ====================
+
+EventLoop* EventLoop::create(const std::string& backend) {
+#ifdef __linux__
+    if (backend.empty() || backend == "epoll")
+        return new EpollEventLoop();
+#else
+    if (backend == "epoll")
+        throw std::runtime_error("epoll backend not available on this platform");
+#endif
+    if (backend.empty() || backend == "poll")
+        return new PollEventLoop();
+    throw std::runtime_error("Unknown event backend: " + backend);
+}
+
+// ==================== BACKEND POLL ====================
+
+PollEventLoop::PollEventLoop() : _fds(), _index() {}
+
+PollEventLoop::~PollEventLoop() {}
+
+static short toPollEvents(int events) {
+    short mask = 0;
+    if (events & EVENT_READ)  mask |= POLLIN;
+    if (events & EVENT_WRITE) mask |= POLLOUT;
+    return mask;
+}
+
+void PollEventLoop::add(int fd, int events) {
+    if (fd < 0)
+        return;
+    if (static_cast<size_t>(fd) >= _index.size())
+        _index.resize(fd + 1, -1);
+    if (_index[fd] != -1) {
+        modify(fd, events);
+        return;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = toPollEvents(events);
+    pfd.revents = 0;
+    _index[fd] = static_cast<int>(_fds.size());
+    _fds.push_back(pfd);
+}
+
+void PollEventLoop::modify(int fd, int events) {
+    if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] == -1)
+        return;
+    _fds[_index[fd]].events = toPollEvents(events);
+}
+
+void PollEventLoop::remove(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] == -1)
+        return;
+
+    // Swap con l'ultimo elemento: rimozione O(1) senza spostare il vettore
+    int pos = _index[fd];
+    int last = static_cast<int>(_fds.size()) - 1;
+    if (pos != last) {
+        _fds[pos] = _fds[last];
+        _index[_fds[pos].fd] = pos;
+    }
+    _fds.pop_back();
+    _index[fd] = -1;
+}
+
+int PollEventLoop::wait(std::vector<ReadyEvent>& ready, int timeout_ms) {
+    ready.clear();
+
+    int count = poll(_fds.empty() ? NULL : &_fds[0], _fds.size(), timeout_ms);
+    if (count <= 0)
+        return count;
+
+    for (size_t i = 0; i < _fds.size() && static_cast<int>(ready.size()) < count; ++i) {
+        short revents = _fds[i].revents;
+        if (!revents)
+            continue;
+
+        ReadyEvent ev;
+        ev.fd = _fds[i].fd;
+        ev.events = 0;
+        if (revents & POLLIN)                         ev.events |= EVENT_READ;
+        if (revents & POLLOUT)                        ev.events |= EVENT_WRITE;
+        if (revents & (POLLERR | POLLHUP | POLLNVAL)) ev.events |= EVENT_ERROR;
+        ready.push_back(ev);
+    }
+    return static_cast<int>(ready.size());
+}
+
+// ==================== BACKEND EPOLL ====================
+
+#ifdef __linux__
+
+EpollEventLoop::EpollEventLoop() : _epfd(-1), _registered(0), _events(64) {
+    _epfd = epoll_create(1024);
+    if (_epfd == -1)
+        throw std::runtime_error("epoll_create() failed: " + std::string(strerror(errno)));
+    fcntl(_epfd, F_SETFD, FD_CLOEXEC);
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    if (_epfd != -1)
+        close(_epfd);
+}
+
+static uint32_t toEpollEvents(int events) {
+    uint32_t mask = 0;
+    if (events & EVENT_READ)  mask |= EPOLLIN;
+    if (events & EVENT_WRITE) mask |= EPOLLOUT;
+    return mask;
+}
+
+void EpollEventLoop::add(int fd, int events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) == 0)
+        ++_registered;
+    else
+        std::cerr << "epoll_ctl(ADD) failed for FD " << fd << std::endl;
+}
+
+void EpollEventLoop::modify(int fd, int events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) != 0)
+        std::cerr << "epoll_ctl(MOD) failed for FD " << fd << std::endl;
+}
+
+void EpollEventLoop::remove(int fd) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if (epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev) == 0 && _registered > 0)
+        --_registered;
+}
+
+int EpollEventLoop::wait(std::vector<ReadyEvent>& ready, int timeout_ms) {
+    ready.clear();
+
+    // Il buffer cresce con il numero di fd registrati, così un singolo
+    // epoll_wait() può restituire tutti gli eventi pronti
+    if (_events.size() < _registered)
+        _events.resize(_registered);
+
+    int count = epoll_wait(_epfd, &_events[0], static_cast<int>(_events.size()), timeout_ms);
+    if (count <= 0)
+        return count;
+
+    for (int i = 0; i < count; ++i) {
+        ReadyEvent ev;
+        ev.fd = _events[i].data.fd;
+        ev.events = 0;
+        if (_events[i].events & EPOLLIN)                ev.events |= EVENT_READ;
+        if (_events[i].events & EPOLLOUT)               ev.events |= EVENT_WRITE;
+        if (_events[i].events & (EPOLLERR | EPOLLHUP))  ev.events |= EVENT_ERROR;
+        ready.push_back(ev);
+    }
+    return count;
+}
+
+#endif // __linux__
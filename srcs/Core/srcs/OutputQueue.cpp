@@ -0,0 +1,167 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/OutputQueue.hpp"
+
+OutputQueue::OutputQueue() : _segments(), _spare(), _pending(0), _responses(0) {}
+
+void OutputQueue::push(const std::string& data) {
+    push(data.data(), data.size());
+}
+
+void OutputQueue::push(const char* data, size_t length) {
+    if (length == 0)
+        return;
+    // Le parti variabili delle risposte sono piccole: la capacità del
+    // buffer dell'ultimo segmento inviato basta quasi sempre
+    _segments.push_back(OutputSegment());
+    _segments.back().data.swap(_spare);
+    _segments.back().data.assign(data, length);
+    _pending += length;
+}
+
+void OutputQueue::push(const struct iovec* iov, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        push(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+}
+
+void OutputQueue::push(SharedBuffer* buffer) {
+    if (buffer->data.empty())
+        return;
+    _segments.push_back(OutputSegment());
+    _segments.back().shared = SharedBuffer::retain(buffer);
+    _pending += buffer->data.size();
+}
+
+void OutputQueue::pushFile(int file_fd, off_t offset, size_t length, OpenFileCache* cache) {
+    OutputSegment segment;
+    segment.file_fd = file_fd;
+    segment.file_offset = offset;
+    segment.file_remaining = length;
+    segment.file_cache = cache;
+    if (length == 0) {
+        releaseSegment(segment);
+        return;
+    }
+    _segments.push_back(segment);
+    _pending += length;
+}
+
+void OutputQueue::releaseSegment(const OutputSegment& segment) {
+    if (segment.shared)
+        SharedBuffer::release(segment.shared);
+    if (!segment.isFile())
+        return;
+    if (segment.file_cache)
+        segment.file_cache->release(segment.file_fd);
+    else
+        close(segment.file_fd);
+}
+
+void OutputQueue::markResponseEnd() {
+    if (_segments.empty() || _segments.back().end_of_response)
+        return;
+    _segments.back().end_of_response = true;
+    ++_responses;
+}
+
+void OutputQueue::popFront() {
+    releaseSegment(_segments.front());
+    if (_segments.front().end_of_response)
+        --_responses;
+    std::string& data = _segments.front().data;
+    if (data.capacity() > _spare.capacity() && data.capacity() <= SPARE_MAX)
+        _spare.swap(data);
+    _segments.pop_front();
+}
+
+ssize_t OutputQueue::writeTo(int fd) {
+    if (_segments.empty())
+        return 0;
+    if (_segments.front().isFile())
+        return writeFile(fd);
+    return writeBuffers(fd);
+}
+
+ssize_t OutputQueue::writeBuffers(int fd) {
+    // Raccoglie più segmenti in un'unica sendmsg(): una sola scrittura
+    // per evento, anche quando header e body sono in buffer separati.
+    // La raccolta si ferma al primo segmento file.
+    struct iovec iov[MAX_IOV];
+    size_t count = 0;
+    std::deque<OutputSegment>::iterator it = _segments.begin();
+    for (; it != _segments.end() && !it->isFile() && count < MAX_IOV; ++it, ++count) {
+        iov[count].iov_base = const_cast<char*>(it->buffer().data() + it->offset);
+        iov[count].iov_len = it->buffer().size() - it->offset;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    // MSG_NOSIGNAL: un peer che chiude non deve terminare il server con SIGPIPE.
+    // MSG_MORE: se segue un file gli header non partono in un segmento TCP a sé
+    int flags = MSG_NOSIGNAL;
+    if (it != _segments.end() && it->isFile())
+        flags |= MSG_MORE;
+    ssize_t sent = sendmsg(fd, &msg, flags);
+
+    // Do NOT check errno after socket operations: ogni errore rimuove il client
+    if (sent <= 0)
+        return -1;
+
+    size_t remaining = static_cast<size_t>(sent);
+    _pending -= remaining;
+    while (remaining > 0 && !_segments.empty()) {
+        OutputSegment& front = _segments.front();
+        size_t available = front.buffer().size() - front.offset;
+        if (remaining >= available) {
+            remaining -= available;
+            popFront();
+        } else {
+            front.offset += remaining;
+            remaining = 0;
+        }
+    }
+    return sent;
+}
+
+ssize_t OutputQueue::writeFile(int fd) {
+    OutputSegment& front = _segments.front();
+    size_t chunk = std::min(front.file_remaining, FILE_CHUNK);
+
+#ifdef __linux__
+    // Il kernel copia direttamente dalla page cache al socket
+    ssize_t sent = sendfile(fd, front.file_fd, &front.file_offset, chunk);
+#else
+    // Fallback portabile: pread() in un buffer piccolo e una send()
+    char buffer[65536];
+    if (chunk > sizeof(buffer))
+        chunk = sizeof(buffer);
+    ssize_t got = pread(front.file_fd, buffer, chunk, front.file_offset);
+    if (got <= 0)
+        return -1;
+    ssize_t sent = send(fd, buffer, got, MSG_NOSIGNAL);
+    if (sent > 0)
+        front.file_offset += sent;
+#endif
+
+    // sent == 0 con byte ancora attesi: file troncato dopo l'fstat().
+    // Do NOT check errno: ogni errore rimuove il client
+    if (sent <= 0)
+        return -1;
+
+    front.file_remaining -= static_cast<size_t>(sent);
+    _pending -= static_cast<size_t>(sent);
+    if (front.file_remaining == 0)
+        popFront();
+    return sent;
+}
+
+void OutputQueue::clear() {
+    for (std::deque<OutputSegment>::iterator it = _segments.begin(); it != _segments.end(); ++it)
+        releaseSegment(*it);
+    _segments.clear();
+    _pending = 0;
+    _responses = 0;
+}
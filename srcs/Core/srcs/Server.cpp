@@ -22,6 +22,7 @@
 
 #include "../../Utils/incs/FileHandler.hpp"
 #include "../../Utils/incs/MimeTypes.hpp"
+#include "../../Utils/incs/Clock.hpp"
 
 #include "../../CGI/incs/CGIExecutor.hpp"
 
@@ -31,21 +32,22 @@
 
 // Static member initialization
 std::vector<Server*> Server::servers;
-std::vector<struct pollfd> Server::poll_fds;
-std::map<int, Client> Server::clients;
+EventLoop* Server::loop = NULL;
+std::vector<FdEntry> Server::fd_table;
+std::vector<int> Server::pending_close;
+BufferPool Server::buffers;
+ClientTable Server::clients;
+OpenFileCache Server::file_cache;
+ResponseCache Server::response_cache;
+std::map<int, CGIProcess*> Server::cgi_processes;
+std::vector<pid_t> Server::cgi_zombies;
+FastCGIPool Server::fastcgi_pool;
+CGIWorkerPool Server::cgi_workers;
+std::deque<int> Server::cgi_waiting;
+TimerWheel Server::timers;
 
 
 
-
-// Helper predicate for find_if
-struct PollFDFinder {
-    int target_fd;
-    PollFDFinder(int fd) : target_fd(fd) {}
-    bool operator()(const struct pollfd& pfd) {
-        return pfd.fd == target_fd;
-    }
-};
-
 Server::Server(const ServerConfig& config) :
 config(config),
 server_fd(-1) {
@@ -55,6 +57,7 @@ server_fd(-1) {
 
 Server::~Server() {
     if (server_fd != -1) {
+        unregisterFd(server_fd);
         close(server_fd);
         std::cout << "Server on port " << ntohs(address.sin_port) << " closed." << std::endl;
     }
@@ -67,25 +70,68 @@ Server::~Server() {
  * Questa funzione esegue tutti i passaggi necessari per creare e configurare
  * un socket server TCP pronto per accettare connessioni:
  * 
+ * 1. Creazione del socket in ascolto (openListenSocket)
+ * 2. Registrazione nel sistema di polling globale
+ */
+void Server::setupSocket() {
+    server_fd = openListenSocket();
+
+    // Registrazione nel sistema globale
+    servers.push_back(this);                        // Aggiunge alla lista server
+    registerFd(server_fd, FD_LISTENER, this, EVENT_READ);  // Monitora eventi di lettura
+
+    std::cout << "Server started on port " << config.getPort() << " (FD: " << server_fd << ")" << std::endl;
+}
+
+/**
+ * @brief Crea un socket TCP in ascolto sulla porta configurata
+ * @return File descriptor del socket
+ * @throws std::runtime_error se fallisce qualsiasi operazione di setup
+ * 
  * 1. Creazione socket TCP/IP
- * 2. Configurazione opzioni socket (riuso indirizzo)
+ * 2. Configurazione opzioni socket (riuso indirizzo, SO_REUSEPORT con più worker)
  * 3. Binding all'indirizzo e porta specificati
  * 4. Attivazione modalità listen per accettare connessioni
  * 5. Configurazione modalità non-bloccante
- * 6. Registrazione nel sistema di polling globale
  */
-void Server::setupSocket() {
+int Server::openListenSocket() {
+    int fd;
+
     // Fase 1: Creazione socket TCP/IP
     // AF_INET = IPv4, SOCK_STREAM = TCP, 0 = protocollo di default
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
         throw std::runtime_error("socket() failed: " + std::string(strerror(errno)));
+    // Gli script avviati con posix_spawn() non devono ereditare il socket
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
 
     // Fase 2: Configurazione opzioni socket
     // SO_REUSEADDR permette di riutilizzare immediatamente l'indirizzo
     // dopo la chiusura del server (evita "Address already in use")
     int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)))
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
+        close(fd);
         throw std::runtime_error("setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    // Niente Nagle: con il pipelining la seconda sendmsg() di una
+    // connessione resterebbe in attesa dell'ACK, che il client ritarda
+    // (~40 ms) finché non riceve tutte le risposte. Su Linux i socket
+    // restituiti da accept() ereditano l'opzione, senza syscall per client.
+    // Gli header seguiti da un file restano uniti grazie a MSG_MORE
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt))) {
+        close(fd);
+        throw std::runtime_error("setsockopt(TCP_NODELAY) failed: " + std::string(strerror(errno)));
+    }
+
+#ifdef SO_REUSEPORT
+    // Con più worker ogni processo ha il proprio socket sulla stessa porta:
+    // il kernel distribuisce le connessioni tra code di accept separate
+    if (config.getWorkerProcesses() > 1 &&
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt))) {
+        close(fd);
+        throw std::runtime_error("setsockopt(SO_REUSEPORT) failed: " + std::string(strerror(errno)));
+    }
+#endif
 
     // Fase 3: Configurazione indirizzo di binding
     memset(&address, 0, sizeof(address));           // Azzera la struttura
@@ -95,24 +141,55 @@ void Server::setupSocket() {
 
     // Fase 4: Binding del socket all'indirizzo
     // Associa il socket all'indirizzo IP e porta specificati
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
         throw std::runtime_error("bind() failed: " + std::string(strerror(errno)));
+    }
 
     // Fase 5: Attivazione modalità listen
     // SOMAXCONN = massimo numero di connessioni in coda
-    if (listen(server_fd, SOMAXCONN) < 0)
+    if (listen(fd, SOMAXCONN) < 0) {
+        close(fd);
         throw std::runtime_error("listen() failed: " + std::string(strerror(errno)));
+    }
+
+#ifdef TCP_DEFER_ACCEPT
+    // Il kernel completa l'handshake ma segnala la connessione solo quando
+    // arrivano i primi dati: niente risvegli per client che tacciono.
+    // Oltre il timeout degli header la connessione viene consegnata comunque
+    if (config.isDeferredAccept()) {
+        int seconds = static_cast<int>(config.getClientHeaderTimeout() / 1000);
+        if (seconds < 1)
+            seconds = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(seconds)))
+            std::cerr << "Warning: TCP_DEFER_ACCEPT not available on port " << config.getPort() << std::endl;
+    }
+#endif
 
     // Fase 6: Configurazione modalità non-bloccante
     // Permette operazioni I/O asincrone senza bloccare il thread
-    if (fcntl(server_fd, F_SETFL, O_NONBLOCK) == -1)
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
+        close(fd);
         throw std::runtime_error("fcntl() failed: " + std::string(strerror(errno)));
+    }
 
-    // Fase 7: Registrazione nel sistema globale
-    servers.push_back(this);                        // Aggiunge alla lista server
-    addPollFD(server_fd, POLLIN);                  // Monitora eventi di lettura
+    return fd;
+}
 
-    std::cout << "Server started on port " << config.getPort() << " (FD: " << server_fd << ")" << std::endl;
+/**
+ * @brief Sostituisce il socket in ascolto con uno nuovo (stessa porta)
+ * 
+ * Usata dal master prima di ogni fork: ogni worker riceve un proprio
+ * socket SO_REUSEPORT e quindi una propria coda di accept.
+ */
+void Server::replaceListenSocket(int fd) {
+    if (server_fd != -1) {
+        unregisterFd(server_fd);
+        close(server_fd);
+    }
+    server_fd = fd;
+    if (server_fd != -1)
+        registerFd(server_fd, FD_LISTENER, this, EVENT_READ);
 }
 
 /**
@@ -138,55 +215,38 @@ void Server::setupSocket() {
  * REFACTORING: Migliorati i nomi delle variabili per maggiore chiarezza
  */
 void Server::handleClient(int client_fd) {
-    Client& current_client = clients[client_fd];
-    std::vector<char> read_buffer(4096);
+    Client& current_client = *clients.find(client_fd);
     
+    // Upload binario con il buffer già svuotato: il resto del body va
+    // dal socket al file senza passare da request_data (splice su Linux)
+    bool direct = current_client.body.isOpen() && !current_client.parser.isChunked()
+                  && !current_client.body.complete()
+                  && current_client.request_data.size() == current_client.parser.bodyOffset();
+
     // ✅ CRITICAL FIX: Only ONE read per poll() cycle as required by evaluation
     // Remove the while loop - only read once per poll() call
-    ssize_t bytes_received_count = recv(client_fd, read_buffer.data(), read_buffer.size(), 0);
+    // Il buffer di lettura serve solo per questo recv(): torna subito al pool
+    char* read_buffer = direct ? NULL : buffers.acquire();
+    ssize_t bytes_received_count = direct
+        ? current_client.body.receive(client_fd)
+        : recv(client_fd, read_buffer, BufferPool::SLAB_SIZE, 0);
+    if (bytes_received_count > 0 && !direct)
+        current_client.appendRequestData(read_buffer, bytes_received_count);
+    buffers.release(read_buffer);
     
     // ✅ CRITICAL FIX: Check ALL return values properly (not just -1 or 0)
-    if (bytes_received_count > 0) {
-        // Accumulate received data in client buffer
-        current_client.appendRequestData(read_buffer.data(), bytes_received_count);
-        
-        try {
-            // Check if we have a complete HTTP request
-            if (current_client.isRequestComplete()) {
-                // Parse the HTTP request (method, URL, headers, body)
-                current_client.parseRequest();
-                
-                // Process request and generate response
-                processRequest(&current_client);
-                
-                // Handle keep-alive: if disabled, close connection
-                if (!current_client.shouldKeepAlive()) {
-                    removeClient(client_fd);
-                    return;
-                }
-                
-                // Reset for next request on same connection
-                current_client.reset();
-            }
-            // If request incomplete, wait for more data in next poll() cycle
-        } catch (const std::exception& parsing_exception) {
-            std::cerr << "Request error: " << parsing_exception.what() << std::endl;
-            
-            // Handle specific errors
-            std::string error_message = parsing_exception.what();
-            if (error_message == "REQUEST_ENTITY_TOO_LARGE") {
-                // Body too large: error 413
-                sendErrorResponse(&current_client, 413, "Request Entity Too Large", servers[0]->config);
-            } else {
-                // Other parsing errors: error 400
-                sendErrorResponse(&current_client, 400, "Bad Request", servers[0]->config);
-            }
-            removeClient(client_fd);
-            return;
-        }
+    if (direct && (bytes_received_count > 0 || current_client.body.failed())) {
+        // Body già nel file: processPipeline() chiude la richiesta quando è completo
+        processPipeline(client_fd);
+    } else if (bytes_received_count > 0) {
+        // Data already appended to the client buffer: process every
+        // complete request it contains (HTTP/1.1 pipelining)
+        processPipeline(client_fd);
     } else if (bytes_received_count == 0) {
         // ✅ CRITICAL FIX: Client closed connection normally - remove client
-        removeClient(client_fd);
+        // once the responses already queued have been written out
+        current_client.close_after_flush = true;
+        updateClientEvents(client_fd);
     } else {
         // ✅ CRITICAL FIX: bytes_received_count < 0 - error occurred
         // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
@@ -196,6 +256,229 @@ void Server::handleClient(int client_fd) {
     }
 }
 
+/**
+ * @brief Elabora in ordine le richieste complete presenti nel buffer del client
+ * @param client_fd File descriptor del client
+ * 
+ * Le risposte vengono accodate nello stesso ordine delle richieste.
+ * Quando in coda ci sono pipeline_depth risposte non ancora inviate
+ * l'elaborazione si ferma (e la lettura viene sospesa): riprende da
+ * handleClientWrite() man mano che le risposte partono.
+ */
+void Server::processPipeline(int client_fd) {
+    Client& client = *clients.find(client_fd);
+    size_t depth = servers[0]->config.getPipelineDepth();
+
+    try {
+        while (!client.close_after_flush && !client.isProducing() && client.output.pendingResponses() < depth) {
+            if (!client.isRequestComplete()) {
+                // Header completi di un upload: il resto del body va su disco
+                if (!client.isSpooling() && client.parser.awaitingBody() && spoolUpload(client))
+                    continue;
+                break;
+            }
+
+#ifdef WEBSERV_ALLOC_STATS
+            size_t heap_allocations = HeapStats::allocations;
+            size_t heap_bytes = HeapStats::bytes;
+#endif
+            // Parse the HTTP request (method, URL, headers, body)
+            client.parseRequest();
+            client.setKeepAlive(client.request.wantsKeepAlive());
+
+            // Process request and generate response
+            processRequest(&client);
+            if (client.isProducing()) {
+                // Il resto della risposta arriverà dalla pipe dello script
+                // o dall'autoindex: le richieste successive attendono la
+                // fine (finishCgi(), handleClientWrite()) per mantenere l'ordine
+                client.nextRequest();
+                break;
+            }
+            client.output.markResponseEnd();
+#ifdef WEBSERV_ALLOC_STATS
+            // Delta letti prima di scrivere il log, che alloca a sua volta
+            heap_allocations = HeapStats::allocations - heap_allocations;
+            heap_bytes = HeapStats::bytes - heap_bytes;
+            std::cerr << "alloc: " << client.request.getMethod() << " " << client.request.getPath()
+                      << " arena " << client.arena.allocations() << "/" << client.arena.bytes()
+                      << " B heap " << heap_allocations << "/" << heap_bytes << " B" << std::endl;
+#endif
+
+            // Handle keep-alive: if disabled, close connection once
+            // the queued responses have been written out
+            if (!client.shouldKeepAlive()) {
+                client.close_after_flush = true;
+            }
+
+            // Keep any pipelined bytes that follow this request
+            client.nextRequest();
+        }
+    } catch (const std::exception& parsing_exception) {
+        std::cerr << "Request error: " << parsing_exception.what() << std::endl;
+
+        // Handle specific errors
+        std::string error_message = parsing_exception.what();
+        client.setKeepAlive(false);
+        client.close_after_flush = true;
+        // Upload interrotto: i file temporanei non sopravvivono alla risposta
+        client.body.discard();
+        client.upload.discard();
+        if (error_message == "REQUEST_ENTITY_TOO_LARGE") {
+            // Body too large: error 413
+            sendErrorResponse(&client, 413, "Request Entity Too Large", servers[0]->config);
+        } else if (error_message == "NOT_IMPLEMENTED") {
+            // Transfer-Encoding diverso da chunked: error 501
+            sendErrorResponse(&client, 501, "Not Implemented", servers[0]->config);
+        } else if (error_message == "HTTP_VERSION_NOT_SUPPORTED") {
+            sendErrorResponse(&client, 505, "HTTP Version Not Supported", servers[0]->config);
+        } else if (error_message == "UPLOAD_WRITE_FAILED") {
+            // Disco pieno o errore di I/O sul file temporaneo
+            sendErrorResponse(&client, 500, "Internal Server Error", servers[0]->config);
+        } else {
+            // Other parsing errors: error 400
+            sendErrorResponse(&client, 400, "Bad Request", servers[0]->config);
+        }
+        client.output.markResponseEnd();
+    }
+
+    updateClientEvents(client_fd);
+}
+
+/**
+ * @brief Decide se il body in arrivo va scritto direttamente su disco
+ * @param client Client con gli header completi e il body ancora in arrivo
+ * @return true se il body del client andrà su disco
+ *
+ * Solo upload veri e propri: POST ammesso, location non CGI con
+ * upload_dir, body multipart/form-data o binario. Form e testo restano
+ * in memoria (vanno decodificati). Un body chunked viene decodificato
+ * man mano e nel file arriva già in chiaro.
+ */
+bool Server::spoolUpload(Client& client) {
+    if (!client.parser.isChunked() && client.parser.contentLength() == 0)
+        return false;
+
+    Request head;
+    head.loadHeaders(client.request_data, client.parser, client.arena);
+    if (head.getMethod() != "POST")
+        return false;
+
+    const std::string& contentType = head.getHeader("Content-Type");
+    if (contentType.find("multipart/form-data") == std::string::npos
+        && contentType.find("application/octet-stream") == std::string::npos
+        && contentType.find("application/binary") == std::string::npos)
+        return false;
+
+    const LocationConfig& location = servers[0]->config.getLocationForPath(head.getPath());
+    const std::vector<std::string>& methods = location.getAllowedMethods();
+    if (std::find(methods.begin(), methods.end(), "POST") == methods.end())
+        return false;
+    const std::string& uploadDir = location.getUploadDir();
+    if (uploadDir.empty() || servers[0]->isCgiRequest(location, head.getPath()))
+        return false;
+    if (!FileHandler::createDirectory(uploadDir))
+        return false;
+
+    if (contentType.find("multipart/form-data") != std::string::npos) {
+        std::string boundary = extractBoundary(contentType);
+        if (boundary.empty())
+            return false;
+        client.upload.open(uploadDir, boundary, client.parser.contentLength());
+        return true;
+    }
+    return client.body.open(uploadDir, client.parser.contentLength());
+}
+
+/**
+ * @brief Ricalcola gli eventi monitorati per un client dopo ogni elaborazione
+ * @param client_fd File descriptor del client
+ * 
+ * - chiusura richiesta: solo EVENT_WRITE finché la coda non è vuota
+ * - pipeline piena o risposta in produzione: solo EVENT_WRITE (niente letture)
+ * - altrimenti EVENT_READ, più EVENT_WRITE se c'è output in coda
+ */
+void Server::updateClientEvents(int client_fd) {
+    Client& client = *clients.find(client_fd);
+
+    if (client.close_after_flush) {
+        if (client.hasPendingOutput())
+            setEvents(client_fd, EVENT_WRITE);
+        else
+            removeClient(client_fd);
+        return;
+    }
+
+    int events = client.hasPendingOutput() ? EVENT_WRITE : 0;
+    if (!client.isProducing() && client.output.pendingResponses() < servers[0]->config.getPipelineDepth())
+        events |= EVENT_READ;
+    setEvents(client_fd, events);
+    armClientTimer(client);
+}
+
+void Server::armClientTimer(Client& client) {
+    const ServerConfig& config = servers[0]->config;
+    Client::Timer kind;
+    unsigned long timeout;
+    if (client.hasPendingOutput()) {
+        kind = Client::TIMER_SEND;
+        timeout = config.getSendTimeout();
+    } else if (client.isProducing()) {
+        kind = Client::TIMER_NONE;
+        timeout = 0;
+    } else if (client.isSpooling() || client.parser.awaitingBody()) {
+        kind = Client::TIMER_BODY;
+        timeout = config.getClientBodyTimeout();
+    } else if (client.parser.started() || client.requests_served == 0) {
+        kind = Client::TIMER_HEADER;
+        timeout = config.getClientHeaderTimeout();
+        // Scadenza unica per tutti gli header: le letture non la spostano
+        if (client.timer == Client::TIMER_HEADER)
+            return;
+    } else {
+        kind = Client::TIMER_KEEPALIVE;
+        timeout = config.getKeepaliveTimeout();
+    }
+
+    client.timer = kind;
+    if (timeout == 0)
+        timers.cancel(client.fd);
+    else
+        timers.arm(client.fd, timeout);
+}
+
+void Server::handleClientTimeouts() {
+    static std::vector<int> expired;
+    timers.advance(expired);
+
+    for (size_t i = 0; i < expired.size(); ++i) {
+        int client_fd = expired[i];
+        Client* found = clients.find(client_fd);
+        if (!found)
+            continue;
+        Client& client = *found;
+
+        // Richiesta iniziata ma non completata in tempo: 408 e chiusura
+        if (!client.hasPendingOutput() && !client.close_after_flush
+            && (client.timer == Client::TIMER_BODY || client.parser.started())) {
+            std::cerr << "Client " << client_fd << " timed out reading the request" << std::endl;
+            client.body.discard();
+            client.upload.discard();
+            client.setKeepAlive(false);
+            client.close_after_flush = true;
+            sendErrorResponse(&client, 408, "Request Timeout", servers[0]->config);
+            client.output.markResponseEnd();
+            updateClientEvents(client_fd);
+            continue;
+        }
+
+        // Connessione inattiva o client che non legge le risposte
+        if (client.timer == Client::TIMER_SEND)
+            std::cerr << "Client " << client_fd << " timed out receiving the response" << std::endl;
+        removeClient(client_fd);
+    }
+}
+
 /**
  * @brief Ottiene la pagina di errore personalizzata per un codice di errore
  * @param errorCode Codice di errore HTTP (es. 404, 500, etc.)
@@ -233,155 +516,205 @@ std::string Server::getErrorPage(int errorCode) const {
     return default_error_page_stream.str();
 }
 
+/**
+ * @brief Precondizioni di una GET/HEAD su un file statico (RFC 7232 §6)
+ * @return true se la copia del client è ancora valida (risposta 304)
+ *
+ * If-None-Match, se presente, esclude If-Modified-Since; gli ETag si
+ * confrontano ignorando il prefisso W/.
+ */
+static bool isNotModified(const Request& request, const OpenFileInfo& file) {
+    if (request.hasHeader("If-None-Match")) {
+        std::string tags = request.getHeader("If-None-Match");
+        size_t start = 0;
+        while (start < tags.size()) {
+            size_t end = tags.find(',', start);
+            if (end == std::string::npos)
+                end = tags.size();
+            size_t first = tags.find_first_not_of(" \t", start);
+            size_t last = tags.find_last_not_of(" \t", end - 1);
+            if (first < end && last != std::string::npos && last >= first) {
+                if (tags.compare(first, 2, "W/") == 0)
+                    first += 2;
+                size_t length = last + 1 - first;
+                if ((length == 1 && tags[first] == '*') || tags.compare(first, length, file.etag) == 0)
+                    return true;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+    if (request.hasHeader("If-Modified-Since")) {
+        time_t since;
+        return Clock::parseHttpDate(request.getHeader("If-Modified-Since"), since) && file.mtime <= since;
+    }
+    return false;
+}
+
 /**
  * @brief Invia un file come risposta HTTP al client
  * @param client Client destinatario della risposta
  * @param path Percorso del file da inviare
  * @param isHeadRequest true per richieste HEAD (solo header, no body)
  * 
- * Questa funzione gestisce l'invio di file statici:
+ * Questa funzione gestisce l'invio di file statici senza copiarli
+ * in memoria:
  * 
- * 1. Lettura del contenuto del file (se non HEAD request)
- * 2. Determinazione del tipo MIME basato sull'estensione
- * 3. Calcolo della dimensione del file per Content-Length
- * 4. Generazione header HTTP appropriati
- * 5. Invio della risposta completa
+ * 1. Lookup nella OpenFileCache (fd, dimensione, MIME, ETag, Last-Modified)
+ * 2. Se If-None-Match / If-Modified-Since indicano che il client ha già
+ *    questa versione: 304 senza body
+ * 3. Se il file è nella ResponseCache: accoda header fissi e body
+ *    condivisi, più la sola parte variabile (Connection, Date)
+ * 4. Altrimenti generazione degli header e, per i file piccoli,
+ *    lettura del body e inserimento nella ResponseCache
+ * 5. Per gli altri file accodamento degli header e del segmento file:
+ *    il body viene inviato con sendfile() a ogni evento di scrittura
  * 
  * Gestisce correttamente:
- * - Richieste HEAD (solo header)
+ * - Richieste HEAD (solo header, nessun riferimento sull'fd)
  * - Tipi MIME automatici
  * - Header standard HTTP/1.1
  * - Gestione errori file non trovati
  */
 void Server::sendFileResponse(Client* client, const std::string& path, bool isHeadRequest) {
-    std::string content;
-    
-    // Per richieste non-HEAD, legge il contenuto del file
-    if (!isHeadRequest) {
-        content = FileHandler::readFile(path);
-    } else {
-        // Per richieste HEAD, verifica solo che il file esista
-        struct stat fileStat;
-        if (stat(path.c_str(), &fileStat) == 0) {
-            content = ""; // Contenuto vuoto per HEAD
-        } else {
-            // File non esiste: invia errore 404
-            sendErrorResponse(client, 404, "Not Found", servers[0]->config);
-            return;
-        }
+    // fd, dimensione e MIME arrivano dalla cache: nessuna open()/fstat()
+    // per i file già visti entro open_file_cache_valid
+    const OpenFileInfo& file = file_cache.lookup(path);
+    if (file.error != 0 || file.is_dir) {
+        sendErrorResponse(client, 404, "Not Found", servers[0]->config);
+        return;
     }
     
-    // Determina il tipo MIME basato sull'estensione del file
-    std::string mimeType = MimeTypes::getType(path);
-    
-    // Calcola la dimensione del contenuto per l'header Content-Length
-    size_t contentLength = 0;
-    if (!isHeadRequest) {
-        contentLength = content.size();
-    } else {
-        // Per HEAD, ottiene la dimensione reale del file
-        struct stat fileStat;
-        if (stat(path.c_str(), &fileStat) == 0) {
-            contentLength = fileStat.st_size;
-        }
+    // Parte variabile degli header: dipende dalla connessione e dall'ora
+    // (la data arriva già formattata da Clock)
+    char tail[Response::TAIL_SIZE];
+    size_t tailLength = Response::writeTail(tail, client->shouldKeepAlive());
+
+    // Revalidation: nessun body e nessun accesso al file
+    if (isNotModified(client->request, file)) {
+        Response response(HTTP_NOT_MODIFIED);
+        response.addHeader("ETag", file.etag);
+        response.addHeader("Last-Modified", file.last_modified);
+        response.addLine(Response::SERVER_NAME);
+        client->output.push(response.headData(), response.headLength());
+        client->output.push(tail, tailLength);
+        return;
     }
 
-    // Costruzione della risposta HTTP
-    std::string response = "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: " + mimeType + "\r\n";
-    response += "Content-Length: " + StringUtils::toString(contentLength) + "\r\n";
-    response += "Server: webserv/1.0\r\n";
-    
-    // Aggiunge header Date con timestamp corrente
-    time_t now = time(0);
-    char* dt = ctime(&now);
-    std::string dateStr(dt);
-    if (!dateStr.empty() && dateStr[dateStr.length()-1] == '\n') {
-        dateStr.erase(dateStr.length()-1);  // Rimuove newline finale
-    }
-    response += "Date: " + dateStr + "\r\n";
-    response += "\r\n";  // Linea vuota che separa header da body
-    
-    // Aggiunge il contenuto solo per richieste non-HEAD
-    if (!isHeadRequest) {
-        response += content;
+    // Hit: nessuna costruzione di header e nessun accesso al file
+    const CachedResponse* cached = response_cache.find(path, file);
+    if (cached) {
+        client->output.push(cached->head);
+        client->output.push(tail, tailLength);
+        if (!isHeadRequest)
+            client->output.push(cached->body);
+        return;
     }
 
-    // Invia la risposta completa al client
-    if (!safeSend(client, response)) {
-        // Send failed - client will be removed by caller
-        removeClient(client->fd);
+    // Determina il tipo MIME basato sull'estensione del file
+    const std::string& mimeType = file.mime;
+    size_t contentLength = static_cast<size_t>(file.size);
+
+    // Costruzione della parte fissa degli header HTTP
+    Response response(HTTP_OK);
+    response.addHeader("Content-Type", mimeType);
+    response.addHeader("Content-Length", contentLength);
+    response.addHeader("ETag", file.etag);
+    response.addHeader("Last-Modified", file.last_modified);
+    response.addLine(Response::SERVER_NAME);
+
+    // File piccolo: una pread() sull'fd già aperto dalla OpenFileCache e
+    // le richieste successive vengono servite dalla memoria
+    if (response_cache.isCacheable(file)) {
+        std::string body(contentLength, '\0');
+        ssize_t got = contentLength ? pread(file.fd, &body[0], contentLength, 0) : 0;
+        if (got == static_cast<ssize_t>(contentLength)) {
+            cached = response_cache.insert(path, file,
+                                           std::string(response.headData(), response.headLength()), body);
+            if (cached) {
+                client->output.push(cached->head);
+                client->output.push(tail, tailLength);
+                if (!isHeadRequest)
+                    client->output.push(cached->body);
+                return;
+            }
+        }
+        // Lettura corta (file troncato nel frattempo): si ripiega su sendfile()
     }
+
+    // Parte fissa e variabile in due segmenti, come per le risposte in cache
+    client->output.push(response.headData(), response.headLength());
+    client->output.push(tail, tailLength);
+
+    // Il body segue gli header come segmento file: la coda tiene un
+    // riferimento sull'fd della cache e lo rilascia a invio concluso
+    if (!isHeadRequest && contentLength > 0)
+        client->output.pushFile(file_cache.acquire(file), 0, contentLength, &file_cache);
 }
 
 void Server::handleDirectoryListing(Client* client, const std::string& path) {
-    try {
-        std::string requestPath = client->request.getPath();
-        std::cout << "DEBUG: Directory listing for path: " << path << ", request path: " << requestPath << std::endl;
-        
-        // Procedi direttamente con il listing (il check del slash è già fatto in handleGetRequest)
-        std::vector<std::string> files = FileHandler::listDirectory(path);
-        std::cout << "DEBUG: Found " << files.size() << " files in directory" << std::endl;
-        std::stringstream html;
-        
-        html << "<!DOCTYPE html>\n<html>\n<head>\n"
-             << "<title>Directory Listing</title>\n"
-             << "<style>\n"
-             << "body { font-family: Arial, sans-serif; margin: 20px; }\n"
-             << "h1 { color: #333; }\n"
-             << ".file-list { list-style: none; padding: 0; }\n"
-             << ".file-list li { margin: 10px 0; padding: 10px; background: #f5f5f5; border-radius: 5px; }\n"
-             << ".file-list a { color: #007bff; text-decoration: none; }\n"
-             << ".file-list a:hover { text-decoration: underline; }\n"
-             << "</style>\n"
-             << "</head>\n<body>\n"
-             << "<h1>Directory Listing for " << requestPath << "</h1>\n"
-             << "<ul class='file-list'>\n";
-
-        // Add parent directory link if not in root
-        if (requestPath != "/") {
-            // Calcola il percorso genitore rimuovendo l'ultimo segmento
-            std::string parentPath = requestPath.substr(0, requestPath.rfind('/', requestPath.length() - 2) + 1);
-            if (parentPath.empty()) parentPath = "/";
-            
-            html << "<li><a href=\"" << parentPath << "\">[DIR] Parent Directory</a></li>\n";
-        }
+    std::string requestPath = client->request.getPath();
+    std::cout << "DEBUG: Directory listing for path: " << path << ", request path: " << requestPath << std::endl;
 
-        // Add files and directories
-        for (size_t i = 0; i < files.size(); ++i) {
-            std::string fullPath = path + "/" + files[i];
-            std::string displayPath = requestPath + files[i];
-            
-            if (FileHandler::isDirectory(fullPath)) {
-                displayPath += "/";
-                html << "<li><a href=\"" << displayPath << "\">[DIR] " << files[i] << "/</a></li>\n";
-            } else {
-                html << "<li><a href=\"" << displayPath << "\">" << files[i] << "</a></li>\n";
-            }
-        }
+    // Procedi direttamente con il listing (il check del slash è già fatto in handleGetRequest)
+    DirectoryListing* listing = new DirectoryListing();
+    if (!listing->open(path, requestPath)) {
+        std::cerr << "Error generating directory listing: cannot open " << path << std::endl;
+        delete listing;
+        sendErrorResponse(client, 500, "Internal Server Error", servers[0]->config);
+        return;
+    }
 
-        html << "</ul>\n</body>\n</html>";
+    std::string content;
+    listing->next(content);
+    // HEAD: pagina intera, così la risposta annuncia il Content-Length
+    // senza body (queueResponse() lo scarta)
+    bool chunked = !listing->finished() && client->request.getVersion() == "HTTP/1.1"
+                   && client->request.getMethod() != "HEAD";
+    if (!chunked) {
+        // Directory piccola (o client HTTP/1.0): pagina intera con Content-Length
+        while (!listing->finished())
+            listing->next(content);
+        delete listing;
+        Response response(HTTP_OK);
+        response.addLine(Response::CONTENT_TYPE_HTML);
+        response.setBody(content);
+        queueResponse(client, response);
+        return;
+    }
 
-        std::string content = html.str();
-        std::string response = "HTTP/1.1 200 OK\r\n";
-        response += "Content-Type: text/html\r\n";
-        response += "Content-Length: " + StringUtils::toString(content.size()) + "\r\n";
-        response += "\r\n";
-        response += content;
+    // Il resto della pagina viene generato man mano che il client la riceve
+    Response response(HTTP_OK);
+    response.addLine(Response::CONTENT_TYPE_HTML);
+    response.addLine(Response::TRANSFER_ENCODING_CHUNKED);
+    response.body() = StringUtils::chunkEncode(content);
+    queueResponse(client, response);
+    client->listing = listing;
+    streamListing(*client);
+}
 
-        if (!safeSend(client, response)) {
-            removeClient(client->fd);
+bool Server::streamListing(Client& client) {
+    while (client.output.pendingBytes() <= STREAM_BUFFER_LIMIT) {
+        std::string content;
+        client.listing->next(content);
+        client.output.push(StringUtils::chunkEncode(content));
+        if (client.listing->finished()) {
+            client.output.push(HTTP_LAST_CHUNK);
+            delete client.listing;
+            client.listing = NULL;
+            return true;
         }
-
-    } catch (const std::exception& e) {
-        std::cerr << "Error generating directory listing: " << e.what() << std::endl;
-        sendErrorResponse(client, 500, "Internal Server Error", servers[0]->config);
     }
+    return false;
 }
 
 bool Server::isCgiRequest(const LocationConfig& location, const std::string& path) const {
     std::cout << "DEBUG: Checking if '" << path << "' is a CGI request" << std::endl;
     std::cout << "DEBUG: Location path: '" << location.getPath() << "'" << std::endl;
+
+    // Con fastcgi_pass ogni richiesta della location va al backend
+    if (!location.getFastCgiPass().empty())
+        return true;
     
     size_t dot_pos = path.find_last_of('.');
     if (dot_pos != std::string::npos) {
@@ -421,13 +754,20 @@ bool Server::isCgiRequest(const LocationConfig& location, const std::string& pat
 void Server::handleGetRequest(Client* client) {
     try {
         const LocationConfig& location = servers[0]->config.getLocationForPath(client->request.getPath());
-        std::string path = servers[0]->config.getFullPath(client->request.getPath());
+        // Buffer riusato tra le richieste: risolvere il percorso non alloca
+        static std::string path;
+        servers[0]->config.getFullPath(client->request.getPath(), path);
         
         std::cout << "DEBUG: Handling GET request for " << client->request.getPath() << std::endl;
         std::cout << "DEBUG: Location path: " << location.getPath() << std::endl;
         std::cout << "DEBUG: Full file path: " << path << std::endl;
         std::cout << "DEBUG: Autoindex setting: " << location.getAutoIndex() << std::endl;
 
+        if (location.isStubStatus()) {
+            sendStatusResponse(client);
+            return;
+        }
+
         // Gestione richieste CGI
         if (isCgiRequest(location, client->request.getPath())) {
             handleCgiRequest(client, location);
@@ -440,15 +780,18 @@ void Server::handleGetRequest(Client* client) {
             return;
         }
 
+        // Un solo lookup nella cache sostituisce stat() di directory e file
+        const OpenFileInfo& file = file_cache.lookup(path);
+
         // Gestione directory
-        if (FileHandler::isDirectory(path)) {
+        if (file.is_dir) {
             handleDirectoryRequest(client, location, path);
             return;
         }
 
         // Gestione file regolari
-        if (FileHandler::fileExists(path)) {
-            sendFileResponse(client, path, false);
+        if (file.error == 0) {
+            sendFileResponse(client, path, client->request.getMethod() == "HEAD");
             return;
         }
 
@@ -468,9 +811,9 @@ void Server::handleRootRequest(Client* client, const LocationConfig& location, c
     std::string indexPath = path + location.getIndex();
     
     // LOGICA CORRETTA: Se esiste index.html, servilo SEMPRE (indipendentemente da autoindex)
-    if (FileHandler::fileExists(indexPath)) {
+    if (file_cache.lookup(indexPath).error == 0) {
         std::cout << "DEBUG: Index file found at " << indexPath << ", serving it" << std::endl;
-        sendFileResponse(client, indexPath, false);
+        sendFileResponse(client, indexPath, client->request.getMethod() == "HEAD");
     } else if (location.getAutoIndex()) {
         // Se NON esiste index.html MA autoindex è abilitato, mostra directory listing
         std::cout << "DEBUG: No index file found, but autoindex is enabled, showing directory listing" << std::endl;
@@ -487,86 +830,638 @@ void Server::handleDirectoryRequest(Client* client, const LocationConfig& locati
     // Redirect se manca lo slash finale
     if (requestPath.empty() || requestPath[requestPath.size() - 1] != '/') {
         std::cout << "DEBUG: Directory request without trailing slash, redirecting to " << requestPath << "/" << std::endl;
-        std::string redirectUrl = requestPath + "/";
-        std::string response = "HTTP/1.1 301 Moved Permanently\r\n";
-        response += "Location: " + redirectUrl + "\r\n";
-        response += "Content-Length: 0\r\n\r\n";
+        Response response(HTTP_MOVED_PERMANENTLY);
+        response.addHeader("Location", requestPath + "/");
+        response.addLine(Response::CONTENT_LENGTH_ZERO);
         
-        if (!safeSend(client, response)) {
-            removeClient(client->fd);
-            return;
-        }
+        queueResponse(client, response);
         return;
     }
     
     // Cerca index file
     std::string indexPath = path + location.getIndex();
     std::cout << "DEBUG: Checking for index file at " << indexPath << std::endl;
-    if (FileHandler::fileExists(indexPath)) {
+    if (file_cache.lookup(indexPath).error == 0) {
         std::cout << "DEBUG: Index file found, serving it" << std::endl;
-        sendFileResponse(client, indexPath, false);
+        sendFileResponse(client, indexPath, client->request.getMethod() == "HEAD");
+        return;
+    }
+    
+    // Autoindex se abilitato
+    std::cout << "DEBUG: No index file found, autoindex setting: " << (location.getAutoIndex() ? "enabled" : "disabled") << std::endl;
+    if (location.getAutoIndex()) {
+        std::cout << "DEBUG: Showing directory listing" << std::endl;
+        handleDirectoryListing(client, path);
+    } else {
+        std::cout << "DEBUG: Autoindex disabled, returning 403" << std::endl;
+        sendErrorResponse(client, 403, "Forbidden", servers[0]->config);
+    }
+}
+
+void Server::handleCgiRequest(Client* client, const LocationConfig& location) {
+    if (!location.getFastCgiPass().empty()) {
+        handleFastCgiRequest(client, location);
+        return;
+    }
+
+    std::string path = servers[0]->config.getFullPath(client->request.getPath());
+    size_t dot_pos = path.find_last_of('.');
+    std::string ext = path.substr(dot_pos);
+    
+    std::string interpreter;
+    if (ext == ".py") interpreter = "/usr/bin/python3";
+    else if (ext == ".sh") interpreter = "/bin/bash";
+    else if (ext == ".php") interpreter = "/usr/bin/php";
+    else if (ext == ".pl") interpreter = "/usr/bin/perl";
+    
+    if (!interpreter.empty()) {
+        try {
+            if (!FileHandler::fileExists(path)) {
+                sendErrorResponse(client, 404, "CGI Script Not Found", servers[0]->config);
+                return;
+            }
+            
+            if (!FileHandler::isExecutable(path)) {
+                chmod(path.c_str(), 0755);
+            }
+            
+            // Lo script parte e il controllo torna subito al loop: input e
+            // output passano dalle pipe registrate come FD_CGI_IN / FD_CGI_OUT
+            CGIExecutor cgi(client->request, location);
+            if (location.getCgiPool() > 0) {
+                handlePooledCgiRequest(client, cgi);
+                return;
+            }
+            CGIProcess* process = new CGIProcess();
+            try {
+                cgi.start(*process);
+            } catch (...) {
+                delete process;
+                throw;
+            }
+            process->client_fd = client->fd;
+            process->client_generation = clients.generation(client->fd);
+            process->allow_chunked = client->request.getVersion() == "HTTP/1.1";
+            process->is_head = client->request.getMethod() == "HEAD";
+            process->deadline = Clock::now() + CGI_TIMEOUT_SECONDS;
+            client->cgi = process;
+            cgi_processes[client->fd] = process;
+
+            registerFd(process->stdout_fd, FD_CGI_OUT, NULL, EVENT_READ, client->fd);
+            if (process->input.empty())
+                closeCgiInput(process);
+            else
+                registerFd(process->stdin_fd, FD_CGI_IN, NULL, EVENT_WRITE, client->fd);
+        } catch (const std::exception& e) {
+            std::cerr << "CGI Error: " << e.what() << std::endl;
+            sendErrorResponse(client, 500, "CGI Execution Failed", servers[0]->config);
+        }
+    } else {
+        sendErrorResponse(client, 403, "Unsupported CGI Extension", servers[0]->config);
+    }
+}
+
+/**
+ * @brief Passa allo script una parte del body della richiesta
+ * @param pipe_fd Pipe verso lo stdin dello script (scrivibile)
+ * 
+ * Una sola write() per evento. Se lo script chiude lo stdin senza
+ * leggere tutto, la pipe viene chiusa e si continua a leggerne l'output.
+ */
+void Server::handleCgiInput(int pipe_fd) {
+    std::map<int, CGIProcess*>::iterator it = cgi_processes.find(fd_table[pipe_fd].peer);
+    if (it == cgi_processes.end())
+        return;
+    CGIProcess* process = it->second;
+
+    size_t remaining = process->input.size() - process->input_offset;
+    ssize_t written = write(pipe_fd, process->input.data() + process->input_offset, remaining);
+    if (written <= 0) {
+        closeCgiInput(process);
+        return;
+    }
+    process->input_offset += static_cast<size_t>(written);
+    if (process->input_offset == process->input.size())
+        closeCgiInput(process);
+}
+
+/**
+ * @brief Legge l'output disponibile dello script e lo accoda al client
+ * @param pipe_fd Pipe dallo stdout dello script (leggibile o chiusa)
+ * 
+ * I dati partono verso il client appena arrivano. Se il client non
+ * tiene il passo la lettura viene sospesa oltre STREAM_BUFFER_LIMIT
+ * e ripresa da handleClientWrite().
+ */
+void Server::handleCgiOutput(int pipe_fd) {
+    std::map<int, CGIProcess*>::iterator it = cgi_processes.find(fd_table[pipe_fd].peer);
+    if (it == cgi_processes.end())
+        return;
+    CGIProcess* process = it->second;
+    Client& client = *clients.find(process->client_fd);
+
+    char buffer[CGIProcess::READ_CHUNK];
+    ssize_t bytes_read = read(pipe_fd, buffer, sizeof(buffer));
+    if (bytes_read <= 0) {
+        // EOF (o errore): lo script ha chiuso lo stdout
+        finishCgi(process);
+        return;
+    }
+
+    bool keep_alive = client.shouldKeepAlive();
+    client.output.push(process->consume(buffer, bytes_read, keep_alive));
+    client.setKeepAlive(keep_alive);
+
+    throttleCgiOutput(process);
+    updateClientEvents(process->client_fd);
+}
+
+void Server::throttleCgiOutput(CGIProcess* process) {
+    if (clients.find(process->client_fd)->output.pendingBytes() <= STREAM_BUFFER_LIMIT)
+        return;
+    // Fuori dal loop e non solo con maschera vuota: un HUP verrebbe
+    // segnalato comunque e il loop girerebbe a vuoto
+    loop->remove(process->stdout_fd);
+    fd_table[process->stdout_fd].events = 0;
+    process->paused = true;
+}
+
+/**
+ * @brief Avvia una richiesta verso il backend FastCGI della location
+ * @param client Client che ha fatto la richiesta
+ * @param location Location con fastcgi_pass
+ * 
+ * Nessun fork: i record vengono inviati su una connessione del pool
+ * e la risposta (record STDOUT, in formato CGI) passa dallo stesso
+ * CGIProcess usato per gli script, con le stesse scadenze.
+ */
+void Server::handleFastCgiRequest(Client* client, const LocationConfig& location) {
+    CGIProcess* process = new CGIProcess();
+    try {
+        CGIExecutor cgi(client->request, location);
+        process->backend = location.getFastCgiPass();
+        process->input = cgi.buildFastCGIRequest();
+        process->stdout_fd = fastcgi_pool.acquire(process->backend, process->reused);
+    } catch (const std::exception& e) {
+        std::cerr << "FastCGI Error: " << e.what() << std::endl;
+        delete process;
+        sendErrorResponse(client, 502, "Bad Gateway", servers[0]->config);
+        return;
+    }
+    process->client_fd = client->fd;
+    process->client_generation = clients.generation(client->fd);
+    process->allow_chunked = client->request.getVersion() == "HTTP/1.1";
+    process->is_head = client->request.getMethod() == "HEAD";
+    process->deadline = Clock::now() + CGI_TIMEOUT_SECONDS;
+    client->cgi = process;
+    cgi_processes[client->fd] = process;
+    attachFastCgiConnection(process);
+}
+
+void Server::attachFastCgiConnection(CGIProcess* process) {
+    int fd = process->stdout_fd;
+    if (process->reused) {
+        // Già registrata come FD_FASTCGI_IDLE: cambia solo il proprietario
+        fastcgi_pool.remove(fd);
+        fd_table[fd].type = FD_FASTCGI;
+        fd_table[fd].peer = process->client_fd;
+        setEvents(fd, EVENT_READ | EVENT_WRITE);
+    } else {
+        registerFd(fd, FD_FASTCGI, NULL, EVENT_READ | EVENT_WRITE, process->client_fd);
+    }
+}
+
+bool Server::retryFastCgi(CGIProcess* process) {
+    if (!process->reused || !process->producedNothing())
+        return false;
+
+    // Connessione del pool chiusa dal backend mentre era inattiva
+    // (es. pm.max_requests di php-fpm): la richiesta riparte da capo
+    unregisterFd(process->stdout_fd);
+    pending_close.push_back(process->stdout_fd);
+    process->stdout_fd = -1;
+    try {
+        process->stdout_fd = fastcgi_pool.acquire(process->backend, process->reused);
+    } catch (const std::exception& e) {
+        std::cerr << "FastCGI Error: " << e.what() << std::endl;
+        return false;
+    }
+    process->input_offset = 0;
+    process->records = FastCGIParser();
+    attachFastCgiConnection(process);
+    return true;
+}
+
+void Server::parkFastCgiConnection(CGIProcess* process) {
+    int fd = process->stdout_fd;
+    process->stdout_fd = -1;
+    if (process->reusable && fastcgi_pool.release(process->backend, fd)) {
+        // Resta nel loop in lettura: qualsiasi evento significa che il
+        // backend l'ha chiusa e viene scartata
+        fd_table[fd].type = FD_FASTCGI_IDLE;
+        fd_table[fd].peer = -1;
+        setEvents(fd, EVENT_READ);
+        return;
+    }
+    unregisterFd(fd);
+    pending_close.push_back(fd);
+}
+
+/**
+ * @brief Gestisce un evento sulla connessione FastCGI
+ * @param fd Connessione verso il backend
+ * @param events Eventi pronti
+ * 
+ * Finché i record della richiesta non sono partiti si scrive,
+ * poi si legge. I record STDOUT passano al convertitore CGI;
+ * END_REQUEST conclude la risposta e libera la connessione.
+ */
+void Server::handleFastCgiEvent(int fd, int events) {
+    if (fd_table[fd].type == FD_FASTCGI_IDLE) {
+        fastcgi_pool.remove(fd);
+        unregisterFd(fd);
+        pending_close.push_back(fd);
+        return;
+    }
+
+    std::map<int, CGIProcess*>::iterator it = cgi_processes.find(fd_table[fd].peer);
+    if (it == cgi_processes.end())
+        return;
+    CGIProcess* process = it->second;
+
+    if (process->input_offset < process->input.size()) {
+        if (!(events & (EVENT_WRITE | EVENT_ERROR)))
+            return;
+        ssize_t sent = send(fd, process->input.data() + process->input_offset,
+                            process->input.size() - process->input_offset, MSG_NOSIGNAL);
+        // Do NOT check errno: connect() fallita o connessione chiusa
+        if (sent <= 0) {
+            if (!retryFastCgi(process))
+                finishCgi(process);
+            return;
+        }
+        process->input_offset += static_cast<size_t>(sent);
+        if (process->input_offset == process->input.size())
+            setEvents(fd, EVENT_READ);
+        return;
+    }
+
+    char buffer[CGIProcess::READ_CHUNK];
+    ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+        // Backend chiuso senza END_REQUEST: connessione non riutilizzabile
+        if (!retryFastCgi(process))
+            finishCgi(process);
+        return;
+    }
+
+    process->records.feed(buffer, received);
+    int type;
+    std::string content;
+    std::string output;
+    bool ended = false;
+    while (!ended && process->records.next(type, content)) {
+        if (type == FastCGI::STDOUT) {
+            output += content;
+        } else if (type == FastCGI::STDERR) {
+            std::cerr << "FastCGI stderr: " << content;
+        } else if (type == FastCGI::END_REQUEST) {
+            ended = true;
+        }
+    }
+
+    if (ended) {
+        // Risposta completa in questo blocco: finishCgi() conosce la
+        // lunghezza e può mantenere la connessione col client.
+        // Byte oltre END_REQUEST: stato della connessione incerto, non si riusa
+        process->append(output.data(), output.size());
+        process->reusable = process->records.empty();
+        finishCgi(process);
+        return;
+    }
+
+    Client& client = *clients.find(process->client_fd);
+    bool keep_alive = client.shouldKeepAlive();
+    client.output.push(process->consume(output.data(), output.size(), keep_alive));
+    client.setKeepAlive(keep_alive);
+    throttleCgiOutput(process);
+    updateClientEvents(process->client_fd);
+}
+
+/**
+ * @brief Assegna la richiesta a un worker persistente della location
+ * @param client Client che ha fatto la richiesta
+ * @param cgi Executor della richiesta (ambiente e percorso dello script)
+ * 
+ * Se tutti i worker della coppia interprete/script sono occupati la
+ * richiesta resta in cgi_waiting: la scadenza corre anche durante
+ * l'attesa, come per uno script forkato.
+ */
+void Server::handlePooledCgiRequest(Client* client, CGIExecutor& cgi) {
+    CGIProcess* process = new CGIProcess();
+    int fd;
+    try {
+        process->pool = cgi.workerSpec();
+        process->input = cgi.buildWorkerRequest();
+        fd = cgi_workers.acquire(process->pool);
+    } catch (...) {
+        delete process;
+        throw;
+    }
+    process->client_fd = client->fd;
+    process->client_generation = clients.generation(client->fd);
+    process->allow_chunked = client->request.getVersion() == "HTTP/1.1";
+    process->is_head = client->request.getMethod() == "HEAD";
+    process->deadline = Clock::now() + CGI_TIMEOUT_SECONDS;
+    client->cgi = process;
+    cgi_processes[client->fd] = process;
+    if (fd == -1)
+        cgi_waiting.push_back(client->fd);
+    else
+        attachCgiWorker(process, fd);
+}
+
+void Server::attachCgiWorker(CGIProcess* process, int fd) {
+    process->stdout_fd = fd;
+    if (static_cast<size_t>(fd) < fd_table.size() && fd_table[fd].type == FD_CGI_WORKER) {
+        // Worker già avviato: resta registrato, cambia solo la richiesta
+        fd_table[fd].peer = process->client_fd;
+        setEvents(fd, EVENT_READ | EVENT_WRITE);
+    } else {
+        registerFd(fd, FD_CGI_WORKER, NULL, EVENT_READ | EVENT_WRITE, process->client_fd);
+    }
+}
+
+void Server::parkCgiWorker(CGIProcess* process) {
+    int fd = process->stdout_fd;
+    process->stdout_fd = -1;
+    if (process->reusable && cgi_workers.release(fd)) {
+        // Libero: qualsiasi evento in lettura significa che è uscito
+        fd_table[fd].peer = -1;
+        setEvents(fd, EVENT_READ);
+        return;
+    }
+    // Limite di richieste raggiunto: alla chiusura del socket il worker
+    // legge EOF ed esce. Una risposta incompleta lo lascia in uno stato
+    // incerto e viene terminato
+    retireCgiWorker(fd, !process->reusable);
+}
+
+void Server::retireCgiWorker(int fd, bool kill_worker) {
+    pid_t pid = cgi_workers.remove(fd);
+    unregisterFd(fd);
+    pending_close.push_back(fd);
+    if (pid > 0) {
+        if (kill_worker)
+            kill(pid, SIGKILL);
+        if (waitpid(pid, NULL, WNOHANG) == 0)
+            cgi_zombies.push_back(pid);
+    }
+}
+
+/**
+ * @brief Gestisce un evento sul socket di un worker di cgi_pool
+ * @param fd Socket del worker
+ * @param events Eventi pronti
+ * 
+ * Come per FastCGI: prima si scrive la richiesta, poi si leggono i
+ * blocchi di output. Il blocco vuoto chiude la risposta e libera il
+ * worker; EOF prima di quel blocco significa che il worker è uscito.
+ */
+void Server::handleCgiWorkerEvent(int fd, int events) {
+    int client_fd = fd_table[fd].peer;
+    std::map<int, CGIProcess*>::iterator it = cgi_processes.find(client_fd);
+    if (client_fd == -1 || it == cgi_processes.end()) {
+        retireCgiWorker(fd, false);
+        return;
+    }
+    CGIProcess* process = it->second;
+
+    if (process->input_offset < process->input.size()) {
+        if (!(events & (EVENT_WRITE | EVENT_ERROR)))
+            return;
+        ssize_t sent = send(fd, process->input.data() + process->input_offset,
+                            process->input.size() - process->input_offset, MSG_NOSIGNAL);
+        // Do NOT check errno: worker uscito
+        if (sent <= 0) {
+            finishCgi(process);
+            return;
+        }
+        process->input_offset += static_cast<size_t>(sent);
+        if (process->input_offset == process->input.size())
+            setEvents(fd, EVENT_READ);
+        return;
+    }
+
+    char buffer[CGIProcess::READ_CHUNK];
+    ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+        finishCgi(process);
+        return;
+    }
+
+    process->frames.feed(buffer, received);
+    std::string chunk;
+    std::string output;
+    bool ended = false;
+    while (!ended && process->frames.next(chunk)) {
+        if (chunk.empty())
+            ended = true;
+        else
+            output += chunk;
+    }
+
+    if (ended) {
+        process->append(output.data(), output.size());
+        process->reusable = process->frames.empty();
+        finishCgi(process);
+        return;
+    }
+
+    Client& client = *clients.find(client_fd);
+    bool keep_alive = client.shouldKeepAlive();
+    client.output.push(process->consume(output.data(), output.size(), keep_alive));
+    client.setKeepAlive(keep_alive);
+    throttleCgiOutput(process);
+    updateClientEvents(client_fd);
+}
+
+void Server::dispatchWaitingCgi() {
+    // Una sola passata: chi non trova un worker libero torna in coda, in ordine
+    size_t count = cgi_waiting.size();
+    for (size_t i = 0; i < count; ++i) {
+        int client_fd = cgi_waiting.front();
+        cgi_waiting.pop_front();
+        std::map<int, CGIProcess*>::iterator it = cgi_processes.find(client_fd);
+        if (it == cgi_processes.end())
+            continue;
+        CGIProcess* process = it->second;
+
+        int fd;
+        try {
+            fd = cgi_workers.acquire(process->pool);
+        } catch (const std::exception& e) {
+            std::cerr << "CGI Error: " << e.what() << std::endl;
+            finishCgi(process);
+            continue;
+        }
+        if (fd == -1)
+            cgi_waiting.push_back(client_fd);
+        else
+            attachCgiWorker(process, fd);
+    }
+}
+
+void Server::finishCgi(CGIProcess* process) {
+    int client_fd = process->client_fd;
+    Client& client = *clients.find(client_fd);
+
+    if (process->producedNothing()) {
+        sendErrorResponse(&client, 502, "Bad Gateway", servers[0]->config);
+    } else {
+        bool keep_alive = client.shouldKeepAlive();
+        client.output.push(process->finish(keep_alive));
+        client.setKeepAlive(keep_alive);
+    }
+    releaseCgi(process, false);
+
+    client.output.markResponseEnd();
+    if (!client.shouldKeepAlive())
+        client.close_after_flush = true;
+
+    // Riprende le richieste pipelined arrivate mentre lo script girava
+    processPipeline(client_fd);
+}
+
+void Server::closeCgiInput(CGIProcess* process) {
+    if (process->stdin_fd == -1)
+        return;
+    unregisterFd(process->stdin_fd);
+    pending_close.push_back(process->stdin_fd);
+    process->stdin_fd = -1;
+    std::string().swap(process->input);
+}
+
+void Server::releaseCgi(CGIProcess* process, bool kill_child) {
+    closeCgiInput(process);
+    if (process->pool.enabled()) {
+        if (process->stdout_fd == -1) {
+            // Ancora in attesa di un worker
+            cgi_waiting.erase(std::remove(cgi_waiting.begin(), cgi_waiting.end(), process->client_fd),
+                              cgi_waiting.end());
+        } else if (kill_child) {
+            retireCgiWorker(process->stdout_fd, true);
+            process->stdout_fd = -1;
+        } else {
+            parkCgiWorker(process);
+        }
+    } else if (process->stdout_fd != -1 && !process->backend.empty() && !kill_child) {
+        parkFastCgiConnection(process);
+    } else if (process->stdout_fd != -1) {
+        unregisterFd(process->stdout_fd);
+        pending_close.push_back(process->stdout_fd);
+        process->stdout_fd = -1;
+    }
+    if (process->pid > 0) {
+        if (kill_child)
+            kill(process->pid, SIGKILL);
+        // Chi ha chiuso lo stdout di solito è già uscito; altrimenti lo
+        // raccoglie reapCgiZombies() senza bloccare il loop
+        if (waitpid(process->pid, NULL, WNOHANG) == 0)
+            cgi_zombies.push_back(process->pid);
+    }
+
+    // Solo se lo slot appartiene ancora alla connessione che ha avviato lo script
+    Client* client = clients.find(process->client_fd, process->client_generation);
+    if (client)
+        client->cgi = NULL;
+    cgi_processes.erase(process->client_fd);
+    delete process;
+}
+
+void Server::checkCgiTimeouts() {
+    if (cgi_processes.empty())
         return;
+    time_t now = Clock::now();
+    std::vector<CGIProcess*> expired;
+    for (std::map<int, CGIProcess*>::iterator it = cgi_processes.begin(); it != cgi_processes.end(); ++it) {
+        if (it->second->deadline <= now)
+            expired.push_back(it->second);
     }
-    
-    // Autoindex se abilitato
-    std::cout << "DEBUG: No index file found, autoindex setting: " << (location.getAutoIndex() ? "enabled" : "disabled") << std::endl;
-    if (location.getAutoIndex()) {
-        std::cout << "DEBUG: Showing directory listing" << std::endl;
-        handleDirectoryListing(client, path);
-    } else {
-        std::cout << "DEBUG: Autoindex disabled, returning 403" << std::endl;
-        sendErrorResponse(client, 403, "Forbidden", servers[0]->config);
+
+    for (size_t i = 0; i < expired.size(); ++i) {
+        CGIProcess* process = expired[i];
+        int client_fd = process->client_fd;
+        Client& client = *clients.find(client_fd);
+        std::cerr << "CGI TIMEOUT: Script exceeded " << CGI_TIMEOUT_SECONDS
+                  << " seconds, killing process " << process->pid << std::endl;
+
+        bool started = process->responseStarted();
+        releaseCgi(process, true);
+        if (started) {
+            // Risposta già partita: l'unico modo di segnalarne la fine è chiudere
+            client.close_after_flush = true;
+            updateClientEvents(client_fd);
+        } else {
+            sendErrorResponse(&client, 504, "Gateway Timeout", servers[0]->config);
+            client.output.markResponseEnd();
+            if (!client.shouldKeepAlive())
+                client.close_after_flush = true;
+            processPipeline(client_fd);
+        }
     }
 }
 
-void Server::handleCgiRequest(Client* client, const LocationConfig& location) {
-    std::string path = servers[0]->config.getFullPath(client->request.getPath());
-    size_t dot_pos = path.find_last_of('.');
-    std::string ext = path.substr(dot_pos);
-    
-    std::string interpreter;
-    if (ext == ".py") interpreter = "/usr/bin/python3";
-    else if (ext == ".sh") interpreter = "/bin/bash";
-    else if (ext == ".php") interpreter = "/usr/bin/php";
-    else if (ext == ".pl") interpreter = "/usr/bin/perl";
-    
-    if (!interpreter.empty()) {
-        try {
-            if (!FileHandler::fileExists(path)) {
-                sendErrorResponse(client, 404, "CGI Script Not Found", servers[0]->config);
-                return;
-            }
-            
-            if (!FileHandler::isExecutable(path)) {
-                chmod(path.c_str(), 0755);
-            }
-            
-            CGIExecutor cgi(client->request, location);
-            std::string output = cgi.execute();
-            
-            if (!safeSend(client, output)) {
-                removeClient(client->fd);
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "CGI Error: " << e.what() << std::endl;
-            if (std::string(e.what()).find("CGI_TIMEOUT:") == 0) {
-                sendErrorResponse(client, 504, "Gateway Timeout", servers[0]->config);
-            } else {
-                sendErrorResponse(client, 500, "CGI Execution Failed", servers[0]->config);
-            }
+void Server::reapCgiZombies() {
+    for (size_t i = 0; i < cgi_zombies.size(); ) {
+        if (waitpid(cgi_zombies[i], NULL, WNOHANG) == 0) {
+            ++i;
+        } else {
+            cgi_zombies[i] = cgi_zombies.back();
+            cgi_zombies.pop_back();
         }
-    } else {
-        sendErrorResponse(client, 403, "Unsupported CGI Extension", servers[0]->config);
     }
 }
 
+int Server::cgiWaitTimeout() {
+    int timeout = -1;
+    if (!cgi_processes.empty()) {
+        time_t now = Clock::now();
+        time_t next = cgi_processes.begin()->second->deadline;
+        for (std::map<int, CGIProcess*>::iterator it = cgi_processes.begin(); it != cgi_processes.end(); ++it)
+            next = std::min(next, it->second->deadline);
+        timeout = (next > now) ? static_cast<int>(next - now) * 1000 : 0;
+    }
+    // Script usciti dopo aver chiuso lo stdout: ricontrollati ogni secondo
+    if (!cgi_zombies.empty() && (timeout == -1 || timeout > 1000))
+        timeout = 1000;
+    return timeout;
+}
+
 void Server::removeClient(int client_fd) {
-    close(client_fd);
-    clients.erase(client_fd);
-    removePollFD(client_fd);
+    Client* client = clients.find(client_fd);
+    if (!client)
+        return;
+    timers.cancel(client_fd);
+    // Uno script che lavora per un client sparito viene terminato
+    if (client->cgi)
+        releaseCgi(client->cgi, true);
+    delete client->listing;
+    // Chiude eventuali file ancora in coda (sendfile interrotto)
+    client->output.clear();
+    clients.close(client_fd);
+    unregisterFd(client_fd);
+    // La close() vera e propria avviene a fine iterazione: così il numero
+    // di fd non può essere riassegnato da accept() mentre nel batch corrente
+    // ci sono ancora eventi pendenti per il vecchio client
+    pending_close.push_back(client_fd);
 }
 
 
+void Server::addConnectionHeaders(Client* client, Response& response) {
+    response.addConnection(client->shouldKeepAlive(), servers[0]->config.getKeepaliveTimeout() / 1000);
+}
+
 void Server::sendErrorResponse(Client* client, int statusCode, const std::string& message, const ServerConfig& config) {
     std::cerr << "DEBUG: sendErrorResponse called for code " << statusCode << std::endl;
     std::string errorPage;
@@ -608,25 +1503,16 @@ void Server::sendErrorResponse(Client* client, int statusCode, const std::string
         errorPage = ss.str();
     }
 
-    std::string response = "HTTP/1.1 " + StringUtils::toString(statusCode) + " " + message + "\r\n";
-    response += "Access-Control-Allow-Origin: *\r\n";
-    response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-    response += "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-    response += "Content-Type: text/html\r\n";
-    response += "Content-Length: " + StringUtils::toString(errorPage.size()) + "\r\n";
-    
-    if (client->shouldKeepAlive()) {
-        response += "Connection: keep-alive\r\n";
-        response += "Keep-Alive: timeout=5, max=100\r\n";
-    } else {
-        response += "Connection: close\r\n";
-    }
-    
-    response += "\r\n" + errorPage;
+    // La status line usa la reason phrase standard: message resta nella pagina
+    Response response(statusCode);
+    response.addLine(Response::CORS_ALLOW_ORIGIN);
+    response.addLine(Response::CORS_ALLOW_METHODS);
+    response.addLine(Response::CORS_ALLOW_HEADERS);
+    response.addLine(Response::CONTENT_TYPE_HTML);
+    addConnectionHeaders(client, response);
+    response.setBody(errorPage);
     
-    if (!safeSend(client, response)) {
-        removeClient(client->fd);
-    }
+    queueResponse(client, response);
 }
 
 
@@ -649,6 +1535,12 @@ void Server::handlePostRequest(Client* client) {
         
         std::cout << "DEBUG: Location path = " << location.getPath() << std::endl;
 
+        // POST verso uno script: il body passa allo stdin del CGI
+        if (isCgiRequest(location, requestPath)) {
+            handleCgiRequest(client, location);
+            return;
+        }
+
         std::string uploadDir = location.getUploadDir();
         std::cout << "DEBUG: Get upload_dir = " << location.getUploadDir() << std::endl;
         std::cout << "DEBUG: Upload directory = " << uploadDir << std::endl;
@@ -667,6 +1559,12 @@ void Server::handlePostRequest(Client* client) {
                 return;
             }
         }
+
+        // Body già scritto nel file temporaneo durante la ricezione
+        if (client->isSpooling()) {
+            handleSpooledUpload(client, uploadDir);
+            return;
+        }
         
         // Extract content type and length from headers
         std::string contentType = client->request.getHeader("Content-Type");
@@ -730,7 +1628,7 @@ void Server::handlePostRequest(Client* client) {
             }
             
             std::string boundary = extractBoundary(contentType);
-            parseMultipartBody(client->request.getBody(), boundary, uploadDir);
+            parseMultipartBody(requestBody.data(), requestBody.size(), boundary, uploadDir);
             sendResponse(client, 200, "Multipart file uploaded successfully");
             return;
         }
@@ -745,9 +1643,10 @@ void Server::handlePostRequest(Client* client) {
             }
             
             std::string filename = "binary_" + StringUtils::toString(time(NULL)) + ".bin";
-            std::string fullPath = FileHandler::getAbsolutePath(uploadDir + "/" + filename);
+            std::string fullPath = FileHandler::sanitizePath(uploadDir + "/" + filename);
             
             if (FileHandler::writeFile(fullPath, client->request.getBody())) {
+                invalidateCachedPath(fullPath);
                 std::string successContent = "<html><body><h1>Binary Data Received</h1>";
                 successContent += "<p>Your binary data has been successfully saved.</p>";
                 successContent += "<p><a href=\"/\">Return to home</a></p></body></html>";
@@ -779,9 +1678,10 @@ void Server::handlePostRequest(Client* client) {
             
             std::string timestamp = StringUtils::toString(time(NULL));
             std::string filename = "form_" + timestamp + ".txt";
-            std::string fullPath = FileHandler::getAbsolutePath(uploadDir + "/" + filename);
+            std::string fullPath = FileHandler::sanitizePath(uploadDir + "/" + filename);
             
             if (FileHandler::writeFile(fullPath, formDataContent)) {
+                invalidateCachedPath(fullPath);
                 std::string successContent = "<html><body><h1>Form Data Received</h1>";
                 successContent += "<p>Your form has been successfully submitted.</p>";
                 successContent += "<p><a href=\"/\">Return to home</a></p></body></html>";
@@ -801,9 +1701,10 @@ void Server::handlePostRequest(Client* client) {
             }
             
             std::string filename = "text_" + StringUtils::toString(time(NULL)) + ".txt";
-            std::string fullPath = FileHandler::getAbsolutePath(uploadDir + "/" + filename);
+            std::string fullPath = FileHandler::sanitizePath(uploadDir + "/" + filename);
             
             if (FileHandler::writeFile(fullPath, client->request.getBody())) {
+                invalidateCachedPath(fullPath);
                 std::string successContent = "<html><body><h1>Text Received</h1>";
                 successContent += "<p>Your text has been successfully saved.</p>";
                 successContent += "<p><a href=\"/\">Return to home</a></p></body></html>";
@@ -854,126 +1755,73 @@ void Server::parseFormUrlEncoded(const std::string& body, std::map<std::string,
 }
 
 
-// Update the parseMultipartBody method to be more robust:
-void Server::parseMultipartBody(const std::string& body, const std::string& boundary, const std::string& uploadDir) {
+void Server::handleSpooledUpload(Client* client, const std::string& uploadDir) {
+    if (client->upload.isOpen()) {
+        // Le parti sono già state salvate durante la ricezione
+        size_t files = client->upload.files();
+        bool complete = client->upload.finish();
+        invalidateUploads(client->upload);
+        if (!complete)
+            throw std::runtime_error("Malformed multipart data");
+        std::cout << "DEBUG: Multipart upload completed: " << files << " file(s)" << std::endl;
+        sendResponse(client, 200, "Multipart file uploaded successfully");
+        return;
+    }
+
+    // Body binario: il file temporaneo è già il file caricato
+    BodySink& body = client->body;
+    std::cout << "DEBUG: Upload spooled to disk: " << body.size() << " bytes" << std::endl;
+    std::string filename = "binary_" + StringUtils::toString(time(NULL)) + ".bin";
+    std::string fullPath = FileHandler::sanitizePath(uploadDir + "/" + filename);
+    if (body.commit(fullPath)) {
+        invalidateCachedPath(fullPath);
+        std::string successContent = "<html><body><h1>Binary Data Received</h1>";
+        successContent += "<p>Your binary data has been successfully saved.</p>";
+        successContent += "<p><a href=\"/\">Return to home</a></p></body></html>";
+        sendResponse(client, 200, successContent);
+    } else {
+        sendErrorResponse(client, 500, "Failed to save binary data", servers[0]->config);
+    }
+}
+
+void Server::invalidateCachedPath(const std::string& path) {
+    // Un file creato può avere un'entry negativa in cache, uno cancellato
+    // un fd ancora aperto: si scarta solo quel percorso
+    file_cache.invalidate(path);
+    response_cache.invalidate(path);
+}
+
+void Server::invalidateUploads(const MultipartUpload& upload) {
+    const std::vector<std::string>& saved = upload.saved();
+    for (size_t i = 0; i < saved.size(); ++i)
+        invalidateCachedPath(saved[i]);
+}
+
+void Server::parseMultipartBody(const char* body, size_t size, const std::string& boundary, const std::string& uploadDir) {
     // Check for empty body first
-    if (body.empty()) {
+    if (size == 0) {
         std::cerr << "ERROR: Received empty body for multipart/form-data request\n";
         throw std::runtime_error("Empty multipart data received");
     }
-    
-    // The full boundary pattern includes -- at the start
-    std::string startBoundary = "--" + boundary;
-    std::string endBoundary = startBoundary + "--";
-    
+
     std::cout << "DEBUG: Multipart processing started\n";
-    std::cout << "DEBUG: Body size: " << body.size() << " bytes\n";
+    std::cout << "DEBUG: Body size: " << size << " bytes\n";
     std::cout << "DEBUG: Boundary: " << boundary << "\n";
-    std::cout << "DEBUG: First 50 chars of body: " << body.substr(0, std::min(body.size(), static_cast<size_t>(50))) << "\n";
-    
-    // Find all boundary positions
-    std::vector<size_t> boundaryPositions;
-    size_t pos = 0;
-    while ((pos = body.find(startBoundary, pos)) != std::string::npos) {
-        boundaryPositions.push_back(pos);
-        pos += startBoundary.length();
+
+    // Body già in memoria (es. chunked): stesso parser degli upload in streaming
+    MultipartUpload upload;
+    upload.open(uploadDir, boundary, size);
+    bool written = upload.write(body, size);
+    bool complete = written && upload.finish();
+    invalidateUploads(upload);
+    if (!written) {
+        std::cerr << "ERROR: Multipart parsing failed\n";
+        throw std::runtime_error(upload.malformed() ? "Malformed multipart data" : "Failed to write uploaded file");
     }
-    
-    if (boundaryPositions.empty()) {
-        std::cerr << "ERROR: No boundaries found in multipart data\n";
+    if (!complete) {
+        std::cerr << "ERROR: Closing boundary not found in multipart data\n";
         throw std::runtime_error("Malformed multipart data");
     }
-    
-    std::cout << "DEBUG: Found " << boundaryPositions.size() << " boundaries\n";
-    
-    // Process each part
-    for (size_t i = 0; i < boundaryPositions.size(); i++) {
-        // Skip the boundary itself
-        size_t partStart = boundaryPositions[i] + startBoundary.length();
-        
-        // Check if this is the final boundary
-        if (body.compare(boundaryPositions[i], endBoundary.length(), endBoundary) == 0) {
-            std::cout << "DEBUG: End boundary found\n";
-            break; // This is the end boundary
-        }
-        
-        // Skip the CRLF after the boundary
-        if (partStart < body.size() && body.compare(partStart, 2, "\r\n") == 0) {
-            partStart += 2;
-        } else {
-            std::cerr << "WARNING: Expected CRLF after boundary not found\n";
-        }
-        
-        // Find the end of this part (next boundary or end of data)
-        size_t partEnd = (i + 1 < boundaryPositions.size()) 
-                         ? boundaryPositions[i + 1]
-                         : body.length();
-                         
-        // Split headers and content
-        size_t headersEnd = body.find("\r\n\r\n", partStart);
-        if (headersEnd == std::string::npos || headersEnd >= partEnd) {
-            std::cerr << "ERROR: Malformed multipart format (headers end not found)\n";
-            continue;
-        }
-        
-        // Extract headers section
-        std::string headers = body.substr(partStart, headersEnd - partStart);
-        
-        // Find content-disposition header
-        size_t dispPos = headers.find("Content-Disposition:");
-        if (dispPos == std::string::npos) {
-            std::cerr << "ERROR: Content-Disposition header not found\n";
-            continue;
-        }
-        
-        // Extract filename
-        size_t filenamePos = headers.find("filename=\"", dispPos);
-        if (filenamePos == std::string::npos) {
-            std::cout << "INFO: No filename found, might be a form field\n";
-            continue; // Skip non-file parts
-        }
-        
-        filenamePos += 10; // Skip "filename=\""
-        size_t filenameEnd = headers.find("\"", filenamePos);
-        if (filenameEnd == std::string::npos) {
-            std::cerr << "ERROR: Malformed filename in Content-Disposition\n";
-            continue;
-        }
-        
-        std::string filename = headers.substr(filenamePos, filenameEnd - filenamePos);
-        if (filename.empty()) {
-            std::cout << "INFO: Empty filename, skipping\n";
-            continue;
-        }
-        
-        // Skip headers and the blank line
-        size_t contentStart = headersEnd + 4; // +4 for \r\n\r\n
-        
-        // Content ends at the next boundary minus \r\n
-        size_t contentEnd = partEnd;
-        if (contentEnd > 2 && body.compare(partEnd - 2, 2, "\r\n") == 0) {
-            contentEnd -= 2; // Remove trailing CRLF before boundary
-        }
-        
-        // Extract binary content
-        std::string content = body.substr(contentStart, contentEnd - contentStart);
-        
-        // Create full path
-        std::string fullPath = uploadDir + "/" + filename;
-        fullPath = FileHandler::sanitizePath(fullPath);
-        
-        std::cout << "DEBUG: Saving file: " << filename << "\n";
-        std::cout << "DEBUG: Full path: " << fullPath << "\n";
-        std::cout << "DEBUG: Content size: " << content.size() << " bytes\n";
-        
-        // Write file
-        if (!FileHandler::writeBinaryFile(fullPath, content)) {
-            std::cerr << "ERROR: Failed to write file: " << fullPath << "\n";
-            throw std::runtime_error("Failed to write uploaded file");
-        }
-        
-        std::cout << "SUCCESS: File '" << filename << "' saved successfully\n";
-    }
 }
 
 void Server::handleDeleteRequest(Client* client) {
@@ -1048,21 +1896,16 @@ void Server::handleDeleteRequest(Client* client) {
 
         if (success) {
             std::cout << "File deleted successfully: " << resolvedPath << std::endl;
+            invalidateCachedPath(resolvedPath);
             // Send success response
-            std::string response = "HTTP/1.1 200 OK\r\n";
-            response += "Content-Type: text/plain\r\n";
-            response += "Content-Length: 7\r\n";
-            response += "Connection: close\r\n";
-            response += "\r\n";
-            response += "Deleted";
+            Response response(HTTP_OK);
+            response.addLine(Response::CONTENT_TYPE_TEXT);
+            response.addLine(Response::CONNECTION_CLOSE);
+            response.setBody("Deleted");
             
-            // Use direct send instead of safeSend to avoid double removal
-            ssize_t bytes_sent = send(client->fd, response.c_str(), response.size(), 0);
-            if (bytes_sent <= 0) {
-                std::cerr << "Failed to send delete response to client " << client->fd << std::endl;
-            }
             // Force close connection after DELETE to avoid keep-alive issues
-            removeClient(client->fd);
+            client->close_after_flush = true;
+            queueResponse(client, response);
         } else {
             std::cerr << "Failed to delete file: " << resolvedPath << std::endl;
             sendErrorResponse(client, 500, "Failed to delete file", servers[0]->config);
@@ -1073,20 +1916,6 @@ void Server::handleDeleteRequest(Client* client) {
     }
 }
 
-void Server::handleRequest(const Request& request, Response& response) {
-    // Implementation of handleRequest that uses the passed parameters
-    if (request.getMethod() == "GET") {
-        response.setStatus(200);
-        response.setBody("Hello from GET handler!");
-    } else if (request.getMethod() == "POST") {
-        response.setStatus(200);
-        response.setBody("Hello from POST handler!");
-    } else {
-        response.setStatus(405);
-        response.setBody("Method Not Allowed");
-    }
-}
-
 void Server::processRequest(Client* client) {
     try {
         try {
@@ -1168,97 +1997,337 @@ void Server::processRequest(Client* client) {
     }
 }
 
-void Server::acceptNewConnection() {
+/**
+ * @brief Accetta una connessione già non bloccante e con FD_CLOEXEC
+ * @return fd del client, -1 se la coda è vuota o accept fallisce
+ *
+ * Su Linux accept4() imposta entrambi i flag nella stessa chiamata;
+ * altrove servono due fcntl() dopo accept().
+ */
+static int acceptClient(int listen_fd) {
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
-    int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-
-    // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
-    if (client_fd < 0) {
-        // Any accept error - just return without logging errno
-        return;
-    }
-
-    // Make client_fd non-blocking
+#ifdef __linux__
+    return accept4(listen_fd, (struct sockaddr*)&client_addr, &client_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &client_len);
+    if (client_fd < 0)
+        return -1;
     // ✅ CRITICAL FIX: Do NOT check errno after fcntl operations (grade = 0)
     if (fcntl(client_fd, F_SETFL, O_NONBLOCK) == -1) {
-        // fcntl failed - close the socket and return
         close(client_fd);
-        return;
+        return -1;
     }
+    fcntl(client_fd, F_SETFD, FD_CLOEXEC);
+    return client_fd;
+#endif
+}
+
+void Server::acceptNewConnection() {
+    // Svuota la coda di accept fino al budget: con un picco di connessioni
+    // un solo risveglio ne accetta molte, ma gli altri eventi non restano
+    // fermi a lungo. Le restanti vengono segnalate al prossimo giro
+    size_t budget = config.getAcceptBudget();
+    for (size_t accepted = 0; accepted < budget; ++accepted) {
+        int client_fd = acceptClient(server_fd);
 
-    addPollFD(client_fd, POLLIN);
-    clients[client_fd] = Client(client_fd);
-    std::cout << "New connection accepted (FD: " << client_fd << ")" << std::endl;
+        // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
+        // Coda vuota o errore (anche EMFILE): si riprova al prossimo evento
+        if (client_fd < 0)
+            return;
+
+        Client& client = clients.open(client_fd);
+        client.parser.setMaxBodySize(config.getClientMaxBodySize());
+        client.arena.setPool(&buffers);
+        registerFd(client_fd, FD_CLIENT, this, EVENT_READ);
+        armClientTimer(client);
+        std::cout << "New connection accepted (FD: " << client_fd << ")" << std::endl;
+    }
 }
 
 void Server::run() {
     std::cout << "Starting server manager..." << std::endl;
+
+    int workers = servers.empty() ? 1 : servers[0]->config.getWorkerProcesses();
+    if (workers > 1) {
+        superviseWorkers(workers);
+        return;
+    }
+    eventLoop();
+}
+
+void Server::eventLoop() {
+    // Il backend viene creato qui (e non in setupSocket) così ogni processo
+    // che entra nel loop possiede il proprio descrittore epoll
+    loop = EventLoop::create(servers.empty() ? "" : servers[0]->config.getEventBackend());
+    std::cout << "Event backend: " << loop->name() << std::endl;
+    if (!servers.empty()) {
+        file_cache.configure(servers[0]->config.getOpenFileCacheMax(), servers[0]->config.getOpenFileCacheValid());
+        response_cache.configure(servers[0]->config.getResponseCacheSize(), servers[0]->config.getResponseCacheMaxFile());
+    }
+    for (size_t fd = 0; fd < fd_table.size(); ++fd) {
+        if (fd_table[fd].type == FD_LISTENER)
+            loop->add(static_cast<int>(fd), EVENT_READ);
+    }
+
+    // Un worker appena creato riparte dall'ora corrente, non da quella del fork()
+    Clock::update();
+    std::vector<ReadyEvent> ready;
     while (true) {
-        // Create poll array for both server sockets and file operations
-        std::vector<struct pollfd> all_pollfds = poll_fds;
-        
-        // Add file operation FDs to poll array
         if (FileHandler::hasPendingOperations()) {
             FileHandler::handleFileOperations();
         }
-        
-        int poll_count = poll(all_pollfds.data(), all_pollfds.size(), -1);
-        if (poll_count == -1)
-            throw std::runtime_error("poll() failed: " + std::string(strerror(errno)));
-
-        for (size_t i = 0; i < all_pollfds.size(); ++i) {
-            // Handle READ events (POLLIN)
-            if (all_pollfds[i].revents & POLLIN) {
-                // Find the appropriate server for this FD
-                bool is_server_fd = false;
-                for (std::vector<Server*>::iterator srv = servers.begin(); srv != servers.end(); ++srv) {
-                    if ((*srv)->getServerFd() == all_pollfds[i].fd) {
-                        (*srv)->acceptNewConnection();
-                        is_server_fd = true;
-                        break;
-                    }
-                }
-                
-                // If not a server FD, it's a client FD - handle incoming data
-                if (!is_server_fd) {
-                    handleClient(all_pollfds[i].fd);
+
+        // Si dorme fino alla prima scadenza: CGI o timer delle connessioni
+        int timeout = cgiWaitTimeout();
+        int next_timer = timers.nextTimeout();
+        if (next_timer != -1 && (timeout == -1 || next_timer < timeout))
+            timeout = next_timer;
+
+        int ready_count = loop->wait(ready, timeout);
+        // Un'unica lettura dell'ora per tutto il lavoro di questa iterazione
+        Clock::update();
+        if (ready_count == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string(loop->name()) + " wait failed: " + std::string(strerror(errno)));
+        }
+
+        for (size_t i = 0; i < ready.size(); ++i) {
+            int fd = ready[i].fd;
+            int events = ready[i].events;
+            if (fd < 0 || static_cast<size_t>(fd) >= fd_table.size())
+                continue;
+
+            // Pipe CGI: HUP/ERR valgono come EOF (stdout) o lettore sparito (stdin)
+            if (fd_table[fd].type == FD_CGI_OUT) {
+                if (events & (EVENT_READ | EVENT_ERROR))
+                    handleCgiOutput(fd);
+                continue;
+            }
+            if (fd_table[fd].type == FD_CGI_IN) {
+                if (events & (EVENT_WRITE | EVENT_ERROR))
+                    handleCgiInput(fd);
+                continue;
+            }
+            if (fd_table[fd].type == FD_FASTCGI || fd_table[fd].type == FD_FASTCGI_IDLE) {
+                handleFastCgiEvent(fd, events);
+                continue;
+            }
+            if (fd_table[fd].type == FD_CGI_WORKER) {
+                handleCgiWorkerEvent(fd, events);
+                continue;
+            }
+
+            // Handle READ events: dispatch via fd table, no scan of servers
+            if (events & EVENT_READ) {
+                const FdEntry& entry = fd_table[fd];
+                if (entry.type == FD_LISTENER) {
+                    entry.server->acceptNewConnection();
+                } else if (entry.type == FD_CLIENT) {
+                    handleClient(fd);
                 }
             }
             
-            // Handle WRITE events (POLLOUT)
-            if (all_pollfds[i].revents & POLLOUT) {
+            // Handle WRITE events: drain the client's output queue
+            if (events & EVENT_WRITE) {
+                if (fd_table[fd].type == FD_CLIENT) {
+                    handleClientWrite(fd);
+                }
                 // Handle file operations
                 if (FileHandler::hasPendingOperations()) {
                     FileHandler::handleFileOperations();
                 }
             }
             
-            // Handle ERROR events (POLLERR, POLLHUP, POLLNVAL)
-            if (all_pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
-                std::cerr << "Poll error on FD " << all_pollfds[i].fd << ": ";
-                if (all_pollfds[i].revents & POLLERR) std::cerr << "POLLERR ";
-                if (all_pollfds[i].revents & POLLHUP) std::cerr << "POLLHUP ";
-                if (all_pollfds[i].revents & POLLNVAL) std::cerr << "POLLNVAL ";
-                std::cerr << std::endl;
-                
+            // Handle ERROR events (POLLERR, POLLHUP, POLLNVAL / EPOLLERR, EPOLLHUP)
+            if ((events & EVENT_ERROR) && fd_table[fd].type == FD_CLIENT) {
+                std::cerr << "Poll error on FD " << fd << std::endl;
                 // Remove problematic client connection
-                if (clients.find(all_pollfds[i].fd) != clients.end()) {
-                    removeClient(all_pollfds[i].fd);
-                }
+                removeClient(fd);
             }
         }
+
+        checkCgiTimeouts();
+        handleClientTimeouts();
+        if (!cgi_waiting.empty())
+            dispatchWaitingCgi();
+        reapCgiZombies();
+        flushPendingClose();
     }
 }
 
-// Helper method to remove poll FD - explicitly defined as it was missing
-void Server::removePollFD(int fd) {
-    std::vector<struct pollfd>::iterator it = 
-        std::find_if(poll_fds.begin(), poll_fds.end(), PollFDFinder(fd));
-    
-    if (it != poll_fds.end()) {
-        poll_fds.erase(it);
+// ==================== MODALITÀ MULTI-PROCESSO ====================
+
+static volatile sig_atomic_t g_stop_workers = 0;
+
+static void onMasterSignal(int signum) {
+    (void)signum;
+    g_stop_workers = 1;
+}
+
+/**
+ * @brief Avvia un worker con i propri socket SO_REUSEPORT
+ * @param index Indice del worker (usato per l'affinità CPU)
+ * @return PID del processo figlio
+ * 
+ * I socket vengono aperti dal master prima del fork, così un bind()
+ * fallito viene segnalato dal master invece che da un figlio già avviato.
+ */
+pid_t Server::spawnWorker(int index) {
+    std::vector<int> listen_fds;
+    try {
+        for (size_t i = 0; i < servers.size(); ++i)
+            listen_fds.push_back(servers[i]->openListenSocket());
+    } catch (...) {
+        for (size_t i = 0; i < listen_fds.size(); ++i)
+            close(listen_fds[i]);
+        throw;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        for (size_t i = 0; i < listen_fds.size(); ++i)
+            close(listen_fds[i]);
+        throw std::runtime_error("fork() failed: " + std::string(strerror(errno)));
+    }
+
+    if (pid == 0) {
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        for (size_t i = 0; i < servers.size(); ++i)
+            servers[i]->replaceListenSocket(listen_fds[i]);
+
+#ifdef __linux__
+        // worker_processes auto: un worker per core, ciascuno sul proprio core
+        if (servers[0]->config.isWorkerAffinityAuto()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(index % CPU_SETSIZE, &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus);
+        }
+#endif
+        try {
+            eventLoop();
+        } catch (const std::exception& e) {
+            std::cerr << "Worker " << index << " fatal error: " << e.what() << std::endl;
+        }
+        _exit(1);
+    }
+
+    for (size_t i = 0; i < listen_fds.size(); ++i)
+        close(listen_fds[i]);
+    std::cout << "Worker " << index << " started (PID: " << pid << ")" << std::endl;
+    return pid;
+}
+
+/**
+ * @brief Processo master: avvia N worker e li riavvia se terminano
+ * @param count Numero di worker da mantenere attivi
+ * 
+ * Il master non accetta connessioni: ogni worker ha il proprio loop
+ * degli eventi, la propria mappa dei client e il proprio socket in ascolto.
+ * SIGINT/SIGTERM al master vengono inoltrati ai worker.
+ */
+void Server::superviseWorkers(int count) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onMasterSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;    // niente SA_RESTART: waitpid() deve tornare con EINTR
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    // I socket originali servivano solo a validare bind() all'avvio. Vanno
+    // chiusi prima dei fork: fanno parte del gruppo SO_REUSEPORT e il
+    // kernel vi smisterebbe connessioni che il master non accetta mai
+    for (size_t i = 0; i < servers.size(); ++i)
+        servers[i]->replaceListenSocket(-1);
+
+    std::vector<pid_t> workers(count, -1);
+    std::vector<time_t> started(count, 0);
+    for (int i = 0; i < count; ++i) {
+        workers[i] = spawnWorker(i);
+        started[i] = time(NULL);
+    }
+
+    std::cout << "Master (PID: " << getpid() << ") supervising " << count << " workers" << std::endl;
+
+    while (!g_stop_workers) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR)
+                continue;
+            break;  // ECHILD: nessun worker rimasto
+        }
+
+        int index = -1;
+        for (int i = 0; i < count; ++i) {
+            if (workers[i] == pid) {
+                index = i;
+                break;
+            }
+        }
+        if (index == -1)
+            continue;
+
+        if (WIFSIGNALED(status))
+            std::cerr << "Worker " << index << " (PID: " << pid << ") killed by signal " << WTERMSIG(status) << std::endl;
+        else
+            std::cerr << "Worker " << index << " (PID: " << pid << ") exited with status " << WEXITSTATUS(status) << std::endl;
+        workers[index] = -1;
+        if (g_stop_workers)
+            break;
+
+        // Evita un ciclo di respawn serrato se il worker muore subito all'avvio
+        if (time(NULL) - started[index] < 1)
+            sleep(1);
+        try {
+            workers[index] = spawnWorker(index);
+            started[index] = time(NULL);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to restart worker " << index << ": " << e.what() << std::endl;
+        }
+    }
+
+    std::cout << "Master shutting down workers..." << std::endl;
+    for (int i = 0; i < count; ++i) {
+        if (workers[i] > 0)
+            kill(workers[i], SIGTERM);
     }
+    for (int i = 0; i < count; ++i) {
+        if (workers[i] > 0)
+            waitpid(workers[i], NULL, 0);
+    }
+}
+
+void Server::registerFd(int fd, FdType type, Server* owner, int events, int peer) {
+    if (fd < 0)
+        return;
+    if (static_cast<size_t>(fd) >= fd_table.size())
+        fd_table.resize(fd + 1);
+    fd_table[fd].type = type;
+    fd_table[fd].server = owner;
+    fd_table[fd].events = events;
+    fd_table[fd].peer = peer;
+    if (loop)
+        loop->add(fd, events);
+}
+
+void Server::unregisterFd(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= fd_table.size())
+        return;
+    if (loop && fd_table[fd].type != FD_NONE)
+        loop->remove(fd);
+    fd_table[fd] = FdEntry();
+}
+
+void Server::flushPendingClose() {
+    for (size_t i = 0; i < pending_close.size(); ++i) {
+        close(pending_close[i]);
+    }
+    pending_close.clear();
 }
 
 int Server::getServerFd() const {
@@ -1266,37 +2335,12 @@ int Server::getServerFd() const {
 }
 
 void Server::sendResponse(Client* client, int status, const std::string& content) {
-    std::string statusText;
-    switch (status) {
-        case 200: statusText = "OK"; break;
-        case 201: statusText = "Created"; break;
-        case 204: statusText = "No Content"; break;
-        case 301: statusText = "Moved Permanently"; break;
-        case 400: statusText = "Bad Request"; break;
-        case 403: statusText = "Forbidden"; break;
-        case 404: statusText = "Not Found"; break;
-        case 405: statusText = "Method Not Allowed"; break;
-        case 500: statusText = "Internal Server Error"; break;
-        case 501: statusText = "Not Implemented"; break;
-        default: statusText = "Unknown";
-    }
-    
-    std::string response = "HTTP/1.1 " + StringUtils::toString(status) + " " + statusText + "\r\n";
-    response += "Content-Type: text/html\r\n";
-    response += "Content-Length: " + StringUtils::toString(content.size()) + "\r\n";
-    
-    if (client->shouldKeepAlive()) {
-        response += "Connection: keep-alive\r\n";
-        response += "Keep-Alive: timeout=5, max=100\r\n";
-    } else {
-        response += "Connection: close\r\n";
-    }
-    
-    response += "\r\n" + content;
+    Response response(status);
+    response.addLine(Response::CONTENT_TYPE_HTML);
+    addConnectionHeaders(client, response);
+    response.setBody(content);
     
-    if (!safeSend(client, response)) {
-        removeClient(client->fd);
-    }
+    queueResponse(client, response);
 }
 
 void Server::cleanup() {
@@ -1304,47 +2348,86 @@ void Server::cleanup() {
         delete *it;
     }
     servers.clear();
-    poll_fds.clear();
+    while (!cgi_processes.empty())
+        releaseCgi(cgi_processes.begin()->second, true);
+    for (size_t i = 0; i < cgi_zombies.size(); ++i)
+        waitpid(cgi_zombies[i], NULL, 0);
+    cgi_zombies.clear();
+    fastcgi_pool.clear();
+    cgi_waiting.clear();
+    cgi_workers.clear();
+    for (int fd = 0; fd < clients.limit(); ++fd) {
+        Client* client = clients.find(fd);
+        if (!client)
+            continue;
+        client->output.clear();
+        close(fd);
+    }
     clients.clear();
+    file_cache.clear();
+    response_cache.clear();
+    buffers.clear();
+    flushPendingClose();
+    fd_table.clear();
+    delete loop;
+    loop = NULL;
 }
 
 void Server::handleOptionsRequest(Client* client) {
-    std::string response = "HTTP/1.1 200 OK\r\n";
-    response += "Access-Control-Allow-Origin: *\r\n";
-    response += "Access-Control-Allow-Methods: POST, GET, OPTIONS\r\n";
-    response += "Access-Control-Allow-Headers: Content-Type, Content-Length\r\n";
-    response += "Content-Length: 0\r\n\r\n";
+    Response response(HTTP_OK);
+    response.addLine(Response::CORS_ALLOW_ORIGIN);
+    response.addHeader("Access-Control-Allow-Methods", std::string("POST, GET, OPTIONS"));
+    response.addLine(Response::CORS_ALLOW_HEADERS_LENGTH);
+    response.addLine(Response::CONTENT_LENGTH_ZERO);
     
-    if (!safeSend(client, response)) {
-        removeClient(client->fd);
-    }
+    queueResponse(client, response);
 }
 
-
-
-// Helper methods
-void Server::addPollFD(int fd, short events) {
-    pollfd pfd;
-    pfd.fd = fd;
-    pfd.events = events;
-    pfd.revents = 0;
-    poll_fds.push_back(pfd);
+/**
+ * @brief Statistiche del processo in formato testo
+ * @param client Client destinatario
+ * 
+ * Con worker_processes > 1 ogni worker ha i propri contatori:
+ * la risposta riflette il worker che ha accettato la connessione.
+ */
+void Server::sendStatusResponse(Client* client) {
+    std::ostringstream body;
+    body << "Active connections: " << clients.size() << "\n"
+         << "Open file cache: entries " << file_cache.size()
+         << ", open fds " << file_cache.openDescriptors()
+         << ", hits " << file_cache.hits()
+         << ", misses " << file_cache.misses() << "\n"
+         << "Response cache: entries " << response_cache.size()
+         << ", memory " << response_cache.memoryUsed() << "/" << response_cache.budget()
+         << ", hits " << response_cache.hits()
+         << ", misses " << response_cache.misses() << "\n"
+         << "FastCGI idle connections: " << fastcgi_pool.idleConnections() << "\n"
+         << "CGI pool workers: " << cgi_workers.size() << "\n"
+         << "Receive buffers: allocated " << buffers.allocations()
+         << ", in use " << buffers.inUse()
+         << ", idle " << buffers.idle()
+         << ", reads " << buffers.acquisitions() << "\n";
+
+    Response response(HTTP_OK);
+    response.addLine(Response::CONTENT_TYPE_TEXT);
+    response.addLine(Response::CACHE_CONTROL_NO_CACHE);
+    response.setBody(body.str());
+
+    queueResponse(client, response);
 }
 
-bool Server::isServerFD(int fd) const {
-    for (std::vector<Server*>::const_iterator it = servers.begin(); it != servers.end(); ++it) {
-        if ((*it)->server_fd == fd) return true;
-    }
-    return false;
-}
 
-const std::vector<struct pollfd>& Server::getPollFds() const {
-    return poll_fds;
+
+const ServerConfig& Server::getConfig() const {
+    return config;
 }
 
-void Server::setPollEvents(size_t index, short events) {
-    if (index < poll_fds.size()) {
-        poll_fds[index].events = events;
+void Server::setEvents(int fd, int events) {
+    if (loop && fd >= 0 && static_cast<size_t>(fd) < fd_table.size() && fd_table[fd].type != FD_NONE
+        && fd_table[fd].events != events) {
+        // Nessuna syscall se la maschera non cambia (caso comune in pipeline)
+        fd_table[fd].events = events;
+        loop->modify(fd, events);
     }
 }
 
@@ -1366,26 +2449,16 @@ void Server::sendMethodNotAllowedResponse(Client* client, const std::vector<std:
                               "<p>Allowed methods: " + allowHeader + "</p>"
                               "<p><a href=\"/\">Return to home</a></p></body></html>";
     
-    std::string response = "HTTP/1.1 405 Method Not Allowed\r\n";
-    response += "Allow: " + allowHeader + "\r\n";
-    response += "Access-Control-Allow-Origin: *\r\n";
-    response += "Access-Control-Allow-Methods: " + allowHeader + "\r\n";
-    response += "Access-Control-Allow-Headers: Content-Type, Content-Length\r\n";
-    response += "Content-Type: text/html\r\n";
-    response += "Content-Length: " + StringUtils::toString(errorContent.size()) + "\r\n";
-    
-    if (client->shouldKeepAlive()) {
-        response += "Connection: keep-alive\r\n";
-        response += "Keep-Alive: timeout=5, max=100\r\n";
-    } else {
-        response += "Connection: close\r\n";
-    }
-    
-    response += "\r\n" + errorContent;
+    Response response(HTTP_METHOD_NOT_ALLOWED);
+    response.addHeader("Allow", allowHeader);
+    response.addLine(Response::CORS_ALLOW_ORIGIN);
+    response.addHeader("Access-Control-Allow-Methods", allowHeader);
+    response.addLine(Response::CORS_ALLOW_HEADERS_LENGTH);
+    response.addLine(Response::CONTENT_TYPE_HTML);
+    addConnectionHeaders(client, response);
+    response.setBody(errorContent);
     
-    if (!safeSend(client, response)) {
-        removeClient(client->fd);
-    }
+    queueResponse(client, response);
 }
 
 void Server::sendOptionsResponse(Client* client, const std::vector<std::string>& allowedMethods) {
@@ -1400,42 +2473,82 @@ void Server::sendOptionsResponse(Client* client, const std::vector<std::string>&
     if (!allowHeader.empty()) allowHeader += ", ";
     allowHeader += "OPTIONS";
     
-    std::string response = "HTTP/1.1 200 OK\r\n";
-    response += "Allow: " + allowHeader + "\r\n";
-    response += "Access-Control-Allow-Origin: *\r\n";
-    response += "Access-Control-Allow-Methods: " + allowHeader + "\r\n";
-    response += "Access-Control-Allow-Headers: Content-Type, Content-Length\r\n";
-    response += "Content-Length: 0\r\n";
-    response += "\r\n";
+    Response response(HTTP_OK);
+    response.addHeader("Allow", allowHeader);
+    response.addLine(Response::CORS_ALLOW_ORIGIN);
+    response.addHeader("Access-Control-Allow-Methods", allowHeader);
+    response.addLine(Response::CORS_ALLOW_HEADERS_LENGTH);
+    response.addLine(Response::CONTENT_LENGTH_ZERO);
     
-    if (!safeSend(client, response)) {
-        removeClient(client->fd);
-    }
+    queueResponse(client, response);
 }
 
-// ✅ CRITICAL FIX: Helper method to safely send data with proper error handling
-// Returns true if data was sent successfully, false if client should be removed
-bool Server::safeSend(Client* client, const std::string& data) {
-    ssize_t bytes_sent = send(client->fd, data.c_str(), data.size(), 0);
-    
-    // ✅ CRITICAL FIX: Check ALL return values properly and do NOT use errno
-    if (bytes_sent > 0) {
-        // Data sent successfully (partial or complete)
-        if (static_cast<size_t>(bytes_sent) == data.size()) {
-            return true; // All data sent
-        } else {
-            // Partial send - in a real implementation we'd need to handle this
-            // For now, consider it successful
-            return true;
-        }
-    } else if (bytes_sent == 0) {
-        // No data sent (shouldn't happen with send, but handle it)
-        std::cerr << "send() returned 0 for client " << client->fd << std::endl;
-        return false;
-    } else {
-        // ✅ CRITICAL FIX: Do NOT check errno after socket operations (grade = 0)
-        // Any send error should be treated as connection failure
-        std::cerr << "send() failed for client " << client->fd << std::endl;
-        return false;
+/**
+ * @brief Accoda una risposta nella coda di output del client
+ * @param client Client destinatario
+ * @param response Risposta HTTP completa
+ * 
+ * Nessuna scrittura diretta sul socket: viene armato EVENT_WRITE e i dati
+ * vengono inviati dal loop principale (handleClientWrite) man mano che il
+ * socket è scrivibile. Se la connessione va chiusa dopo la risposta, la
+ * lettura viene disattivata finché la coda non è svuotata.
+ * 
+ * Per le richieste HEAD il body viene scartato e resta solo il blocco header.
+ */
+void Server::queueResponse(Client* client, Response& response) {
+    // HEAD: stessi header della GET (Content-Length compreso), nessun body.
+    // Un body inviato comunque verrebbe letto come inizio della risposta
+    // successiva sulla stessa connessione
+    if (client->request.getMethod() == "HEAD")
+        response.dropBody();
+    response.addDate();
+    client->prepare_response(response);
+}
+
+/**
+ * @brief Svuota (in parte) la coda di output di un client scrivibile
+ * @param client_fd File descriptor del client
+ * 
+ * Una sola scrittura per evento; quando la coda è vuota EVENT_WRITE
+ * viene disarmato oppure, se richiesto, la connessione viene chiusa.
+ */
+void Server::handleClientWrite(int client_fd) {
+    Client* found = clients.find(client_fd);
+    if (!found)
+        return;
+    Client& client = *found;
+
+    if (!client.send_pending_data()) {
+        removeClient(client_fd);
+        return;
+    }
+
+    // Il client ha smaltito l'output: riprende la lettura dallo script
+    if (client.cgi && client.cgi->paused && client.output.pendingBytes() <= STREAM_BUFFER_LIMIT / 2) {
+        CGIProcess* process = client.cgi;
+        int events = EVENT_READ;
+        if ((!process->backend.empty() || process->pool.enabled()) && process->input_offset < process->input.size())
+            events |= EVENT_WRITE;
+        process->paused = false;
+        fd_table[process->stdout_fd].events = events;
+        loop->add(process->stdout_fd, events);
+    }
+
+    // Autoindex in corso: il pezzo successivo solo quando la coda si è svuotata a metà
+    if (client.listing && client.output.pendingBytes() <= STREAM_BUFFER_LIMIT / 2 && streamListing(client)) {
+        client.output.markResponseEnd();
+        if (!client.shouldKeepAlive())
+            client.close_after_flush = true;
+        processPipeline(client_fd);
+        return;
+    }
+
+    // Una risposta è partita: se la pipeline era piena riprende
+    // l'elaborazione delle richieste già presenti nel buffer
+    if (!client.close_after_flush && client.hasUnparsedData()
+        && client.output.pendingResponses() < servers[0]->config.getPipelineDepth()) {
+        processPipeline(client_fd);
+        return;
     }
+    updateClientEvents(client_fd);
 }
@@ -0,0 +1,154 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/TimerWheel.hpp"
+#include "../../Utils/incs/Clock.hpp"
+
+TimerWheel::TimerWheel() : _nodes(), _heads(LEVELS * SLOTS, -1), _tick(toTick(Clock::milliseconds())), _count(0) {}
+
+unsigned long TimerWheel::toTick(unsigned long ms) {
+    return ms / TICK_MS;
+}
+
+void TimerWheel::arm(int id, unsigned long delay_ms) {
+    if (static_cast<size_t>(id) >= _nodes.size()) {
+        Node empty = { -1, -1, 0, -1 };
+        _nodes.resize(id + 1, empty);
+    }
+    if (_nodes[id].slot != -1)
+        unlink(id);
+    else
+        ++_count;
+
+    // Arrotondato per eccesso: un timer non scade mai prima del ritardo
+    unsigned long expires = toTick(Clock::milliseconds() + delay_ms + TICK_MS - 1);
+    _nodes[id].expires = std::max(expires, _tick + 1);
+    insert(id);
+}
+
+void TimerWheel::cancel(int id) {
+    if (!armed(id))
+        return;
+    unlink(id);
+    _nodes[id].slot = -1;
+    --_count;
+}
+
+bool TimerWheel::armed(int id) const {
+    return id >= 0 && static_cast<size_t>(id) < _nodes.size() && _nodes[id].slot != -1;
+}
+
+/**
+ * @brief Inserisce il nodo nel livello adatto alla distanza dalla scadenza
+ */
+void TimerWheel::insert(int id) {
+    Node& node = _nodes[id];
+    unsigned long delta = (node.expires > _tick) ? node.expires - _tick : 0;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << (LEVEL_BITS * (level + 1))))
+        ++level;
+    // Oltre l'ultimo livello: parcheggiato alla distanza massima, viene
+    // ricollocato a ogni giro finché non rientra
+    unsigned long expires = node.expires;
+    unsigned long span = 1UL << (LEVEL_BITS * LEVELS);
+    if (delta >= span)
+        expires = _tick + span - 1;
+
+    int slot = level * SLOTS + ((expires >> (LEVEL_BITS * level)) & (SLOTS - 1));
+    node.slot = slot;
+    node.prev = -1;
+    node.next = _heads[slot];
+    if (node.next != -1)
+        _nodes[node.next].prev = id;
+    _heads[slot] = id;
+}
+
+void TimerWheel::unlink(int id) {
+    Node& node = _nodes[id];
+    if (node.prev != -1)
+        _nodes[node.prev].next = node.next;
+    else
+        _heads[node.slot] = node.next;
+    if (node.next != -1)
+        _nodes[node.next].prev = node.prev;
+}
+
+/**
+ * @brief Ridistribuisce sul livello inferiore lo slot corrente di un livello
+ */
+void TimerWheel::cascade(int level) {
+    size_t index = (_tick >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    // Prima il livello sopra, se anche lui ha completato un giro
+    if (index == 0 && level + 1 < LEVELS)
+        cascade(level + 1);
+
+    int slot = level * SLOTS + index;
+    int id = _heads[slot];
+    _heads[slot] = -1;
+    while (id != -1) {
+        int next = _nodes[id].next;
+        insert(id);
+        id = next;
+    }
+}
+
+void TimerWheel::advance(std::vector<int>& expired) {
+    expired.clear();
+    unsigned long target = toTick(Clock::milliseconds());
+    if (_count == 0) {
+        _tick = std::max(_tick, target);
+        return;
+    }
+
+    while (_tick < target) {
+        ++_tick;
+        size_t index = _tick & (SLOTS - 1);
+        if (index == 0)
+            cascade(1);
+
+        int id = _heads[index];
+        _heads[index] = -1;
+        while (id != -1) {
+            int next = _nodes[id].next;
+            _nodes[id].slot = -1;
+            --_count;
+            expired.push_back(id);
+            id = next;
+        }
+        if (_count == 0) {
+            _tick = target;
+            break;
+        }
+    }
+}
+
+int TimerWheel::nextTimeout() const {
+    if (_count == 0)
+        return -1;
+
+    // Prossimo tick in cui il loop deve lavorare: il primo slot pieno del
+    // livello 0 oppure, se ci sono timer più lontani, la prossima
+    // redistribuzione (fine del giro del livello 0)
+    unsigned long next = 0;
+    for (size_t k = 1; k <= SLOTS; ++k) {
+        if (_heads[(_tick + k) & (SLOTS - 1)] != -1) {
+            next = _tick + k;
+            break;
+        }
+    }
+    for (size_t slot = SLOTS; slot < _heads.size(); ++slot) {
+        if (_heads[slot] != -1) {
+            unsigned long wrap = (_tick | (SLOTS - 1)) + 1;
+            if (next == 0 || wrap < next)
+                next = wrap;
+            break;
+        }
+    }
+
+    unsigned long current = Clock::milliseconds();
+    unsigned long deadline = next * TICK_MS;
+    if (deadline <= current)
+        return 0;
+    unsigned long wait = deadline - current;
+    return (wait > static_cast<unsigned long>(INT_MAX)) ? INT_MAX : static_cast<int>(wait);
+}
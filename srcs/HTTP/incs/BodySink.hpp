@@ -0,0 +1,101 @@
+/**
+ * @file BodySink.hpp
+ * @brief Body di un upload scritto su disco man mano che arriva
+ *
+ * Invece di accumulare l'intero body in request_data, i byte che
+ * seguono gli header vengono scritti in un file temporaneo nella
+ * upload_dir della location (".upload-XXXXXX") e tolti dal buffer:
+ * la memoria per connessione resta quella di un recv(), qualunque sia
+ * client_max_body_size. A upload completo commit() rinomina il file
+ * nel nome definitivo; un upload interrotto (client disconnesso,
+ * errore) viene cancellato.
+ *
+ * Il file temporaneo sta nella stessa directory della destinazione,
+ * quindi rename() è atomico: nessuno vede mai un file a metà.
+ *
+ * Per i body binari receive() salta anche request_data: su Linux i byte
+ * passano socket -> pipe -> file con splice() senza mai entrare nello
+ * spazio utente; altrove (o se la pipe non si può creare) con una
+ * recv() su un buffer grande e una write() sul file.
+ */
+
+#ifndef BODYSINK_HPP
+#define BODYSINK_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class BodySink {
+public:
+    /** @brief Byte massimi spostati dal socket a ogni receive() (capacità della pipe) */
+    static const size_t RECEIVE_SIZE = 1024 * 1024;
+
+    BodySink();
+
+    /** @brief La copia è sempre chiusa: il file appartiene a un solo client */
+    BodySink(const BodySink& other);
+    BodySink& operator=(const BodySink& other);
+
+    /** @brief Cancella il file temporaneo se non è stato confermato */
+    ~BodySink();
+
+    /**
+     * @brief Crea il file temporaneo
+     * @param dir Directory di destinazione (deve esistere)
+     * @param expected Byte attesi (Content-Length, 0 se non noti)
+     * @return false se il file non può essere creato
+     */
+    bool open(const std::string& dir, size_t expected);
+
+    /**
+     * @brief Accoda un blocco di body al file
+     * @return false se il disco rifiuta i dati (spazio esaurito, errore di I/O)
+     */
+    bool write(const char* data, size_t length);
+
+    /**
+     * @brief Sposta il body dal socket al file (una sola lettura dal socket)
+     * @param socket_fd Socket del client, con il buffer di ricezione già svuotato
+     * @return Byte ricevuti, 0 se il client ha chiuso, -1 in caso di errore
+     *
+     * Non legge mai oltre i byte attesi: una richiesta pipelined
+     * successiva resta nel socket. Se a fallire è il disco, failed()
+     * diventa true.
+     */
+    ssize_t receive(int socket_fd);
+
+    /**
+     * @brief Rende definitivo il file con rename()
+     * @param path Nome finale (stesso filesystem della directory temporanea)
+     * @return false se rename() fallisce: il file temporaneo viene cancellato
+     */
+    bool commit(const std::string& path);
+
+    /** @brief Chiude e cancella il file temporaneo */
+    void discard();
+
+    bool isOpen() const { return _fd != -1; }
+    /** @brief true quando sono arrivati tutti i byte attesi */
+    bool complete() const { return _received == _expected; }
+    size_t size() const { return _received; }
+    size_t remaining() const { return _expected - _received; }
+    /** @brief true se una scrittura sul file è fallita */
+    bool failed() const { return _failed; }
+
+    /** @brief Descrittore del file temporaneo, per rileggerlo prima del commit */
+    int fd() const { return _fd; }
+
+private:
+    int         _fd;
+    std::string _path;
+    size_t      _expected;
+    size_t      _received;
+    bool        _failed;
+    int         _pipe[2];       ///< Pipe per splice(), creata al primo receive()
+    size_t      _pipe_size;
+
+    ssize_t receiveCopy(int socket_fd, size_t length);
+    bool openPipe();
+    void closePipe();
+};
+
+#endif // BODYSINK_HPP
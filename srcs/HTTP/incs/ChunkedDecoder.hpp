@@ -0,0 +1,84 @@
+/**
+ * @file ChunkedDecoder.hpp
+ * @brief Decodifica incrementale di Transfer-Encoding: chunked
+ *
+ * Il decoder riprende dal punto in cui si era fermato a ogni blocco
+ * ricevuto: righe di dimensione, estensioni e trailer possono essere
+ * spezzati in qualsiasi punto. I dati dei chunk vengono spostati con
+ * memmove() in una destinazione che può coincidere con l'input (la
+ * destinazione non supera mai la lettura), così RequestParser decodifica
+ * il body direttamente nel buffer di ricezione, senza copie intermedie.
+ *
+ * Il limite del body vale sulla somma dei chunk ed è controllato appena
+ * si legge la riga di dimensione, prima che arrivino i dati.
+ */
+
+#ifndef CHUNKEDDECODER_HPP
+#define CHUNKEDDECODER_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class ChunkedDecoder {
+public:
+    /** @brief Esito di decode() */
+    enum Status {
+        NEED_MORE,  ///< Servono altri byte
+        COMPLETE,   ///< Letto il chunk finale e i trailer
+        ERROR       ///< Codifica non valida: vedi errorCode()
+    };
+
+    /** @brief Lunghezza massima di una riga di estensioni o di trailer */
+    static const size_t MAX_LINE_SIZE = 32768;
+
+    ChunkedDecoder();
+
+    /**
+     * @brief Prepara il decoder per un nuovo body
+     * @param max_body Limite della somma dei chunk (client_max_body_size)
+     */
+    void reset(size_t max_body);
+
+    /**
+     * @brief Decodifica il blocco successivo
+     * @param data Byte codificati
+     * @param length Numero di byte disponibili
+     * @param out Destinazione dei dati (può sovrapporsi a data, purché out <= data)
+     * @param consumed Byte di input esaminati
+     * @param produced Byte decodificati scritti in out
+     * @return NEED_MORE, COMPLETE (i byte dopo consumed non appartengono al body) o ERROR
+     */
+    Status decode(const char* data, size_t length, char* out, size_t& consumed, size_t& produced);
+
+    /** @brief Byte decodificati finora */
+    size_t total() const { return _total; }
+
+    /** @brief Codice HTTP in caso di ERROR (400 o 413) */
+    int errorCode() const { return _error; }
+
+private:
+    enum State {
+        S_SIZE,
+        S_EXTENSION,
+        S_SIZE_LF,
+        S_DATA,
+        S_DATA_CR,
+        S_DATA_LF,
+        S_TRAILER_START,
+        S_TRAILER_LINE,
+        S_TRAILER_END_LF,
+        S_DONE,
+        S_ERROR
+    };
+
+    State   _state;
+    size_t  _remaining;     ///< Dimensione in lettura, poi byte mancanti del chunk
+    size_t  _digits;
+    size_t  _line;
+    size_t  _total;
+    size_t  _max_body;
+    int     _error;
+
+    void fail(int code);
+};
+
+#endif // CHUNKEDDECODER_HPP
@@ -0,0 +1,61 @@
+/**
+ * @file DirectoryListing.hpp
+ * @brief Pagina di autoindex generata a pezzi mentre viene inviata
+ *
+ * La directory resta aperta e ogni chiamata a next() legge con
+ * readdir() solo le voci che servono per circa CHUNK_SIZE byte di HTML.
+ * Il server produce il pezzo successivo quando la coda del client
+ * scende sotto STREAM_BUFFER_LIMIT: una directory enorme non occupa
+ * mai più di qualche blocco in memoria e il primo byte parte subito.
+ */
+
+#ifndef DIRECTORYLISTING_HPP
+#define DIRECTORYLISTING_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class DirectoryListing {
+public:
+    /** @brief Byte di HTML prodotti (circa) a ogni next() */
+    static const size_t CHUNK_SIZE = 16384;
+
+    DirectoryListing();
+
+    /** @brief Chiude la directory se la pagina non è stata completata */
+    ~DirectoryListing();
+
+    /**
+     * @brief Apre la directory da elencare
+     * @param path Percorso sul filesystem
+     * @param request_path Percorso richiesto (base dei link, termina con '/')
+     * @return false se la directory non può essere aperta
+     */
+    bool open(const std::string& path, const std::string& request_path);
+
+    /**
+     * @brief Accoda a out il pezzo successivo della pagina
+     *
+     * Il primo pezzo contiene l'intestazione HTML, l'ultimo la chiusura
+     * della pagina; dopo l'ultimo finished() diventa true.
+     */
+    void next(std::string& out);
+
+    /** @brief true quando la pagina è stata prodotta per intero */
+    bool finished() const { return _state == DONE; }
+
+private:
+    enum State { HEAD, ENTRIES, DONE };
+
+    DIR*        _dir;
+    std::string _path;
+    std::string _request_path;
+    State       _state;
+
+    // Possiede un DIR*: non copiabile
+    DirectoryListing(const DirectoryListing&);
+    DirectoryListing& operator=(const DirectoryListing&);
+
+    void close();
+};
+
+#endif // DIRECTORYLISTING_HPP
@@ -0,0 +1,147 @@
+/**
+ * @file MultipartParser.hpp
+ * @brief Parser incrementale di multipart/form-data
+ *
+ * Il body viene consumato a blocchi di qualsiasi dimensione, così come
+ * arrivano dal socket: niente body intero in memoria, niente copie di
+ * header e contenuto. Il delimitatore "\r\n--boundary" viene cercato
+ * con Boyer-Moore-Horspool; gli ultimi (lunghezza - 1) byte di ogni
+ * blocco restano in sospeso, così un delimitatore a cavallo tra due
+ * blocchi viene riconosciuto.
+ *
+ * Ogni parte viene notificata a un MultipartHandler: header grezzi
+ * all'inizio, poi il contenuto a pezzi, poi la fine della parte.
+ * MultipartUpload è l'handler che scrive i file caricati su disco.
+ */
+
+#ifndef MULTIPARTPARSER_HPP
+#define MULTIPARTPARSER_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "BodySink.hpp"
+
+/**
+ * @brief Riceve gli eventi del parser; false interrompe il parsing
+ */
+class MultipartHandler {
+public:
+    virtual ~MultipartHandler() {}
+
+    /** @brief Inizio di una parte (header senza la riga vuota finale) */
+    virtual bool partBegin(const std::string& headers) = 0;
+    /** @brief Porzione del contenuto della parte corrente */
+    virtual bool partData(const char* data, size_t length) = 0;
+    /** @brief Fine della parte corrente */
+    virtual bool partEnd() = 0;
+};
+
+class MultipartParser {
+public:
+    /** @brief Dimensione massima degli header di una parte */
+    static const size_t MAX_PART_HEADER_SIZE = 16384;
+
+    MultipartParser();
+
+    /**
+     * @brief Prepara il parser per un nuovo body
+     * @param boundary Parametro boundary del Content-Type
+     * @param handler Destinatario degli eventi
+     */
+    void reset(const std::string& boundary, MultipartHandler* handler);
+
+    /**
+     * @brief Consuma il blocco successivo del body
+     * @return false se il body è malformato o l'handler ha rifiutato i dati
+     */
+    bool feed(const char* data, size_t length);
+
+    /** @brief true dopo il delimitatore di chiusura "--boundary--" */
+    bool isComplete() const { return _state == S_DONE; }
+    bool hasFailed() const { return _state == S_ERROR; }
+
+private:
+    enum State {
+        S_SEARCH,           ///< Preambolo o contenuto: si cerca il delimitatore
+        S_BOUNDARY_END,     ///< Dopo il delimitatore: "--" oppure CRLF
+        S_BOUNDARY_LF,
+        S_CLOSE_DASH,
+        S_HEADERS,
+        S_DONE,             ///< Epilogo: il resto viene ignorato
+        S_ERROR
+    };
+
+    State               _state;
+    std::string         _delimiter;     ///< "\r\n--" + boundary
+    size_t              _skip[256];     ///< Tabella di salto di Horspool
+    std::string         _tail;          ///< Byte in sospeso dal blocco precedente
+    std::string         _headers;
+    bool                _in_part;
+    MultipartHandler*   _handler;
+
+    size_t find(const char* data, size_t length) const;
+    bool search(const char*& data, size_t& length);
+    bool emit(const char* data, size_t length);
+    bool boundaryFound();
+    bool fail();
+};
+
+/**
+ * @brief Salva su disco le parti con filename di un body multipart
+ *
+ * Ogni file viene scritto in un file temporaneo (BodySink) e rinominato
+ * a fine parte; i campi senza filename vengono ignorati. Come BodySink,
+ * la copia è sempre chiusa e la distruzione scarta la parte in corso.
+ */
+class MultipartUpload : public MultipartHandler {
+public:
+    MultipartUpload();
+    MultipartUpload(const MultipartUpload& other);
+    MultipartUpload& operator=(const MultipartUpload& other);
+    virtual ~MultipartUpload();
+
+    /**
+     * @brief Inizia un upload
+     * @param dir Directory di destinazione (upload_dir)
+     * @param boundary Boundary del Content-Type
+     * @param expected Dimensione del body (Content-Length)
+     */
+    void open(const std::string& dir, const std::string& boundary, size_t expected);
+
+    /** @brief Passa al parser il blocco successivo del body */
+    bool write(const char* data, size_t length);
+
+    /** @brief true se il body era completo e tutti i file sono stati salvati */
+    bool finish();
+
+    /** @brief Interrompe l'upload, cancellando la parte in corso */
+    void discard();
+
+    bool isOpen() const { return _open; }
+    bool complete() const { return _received == _expected; }
+    size_t remaining() const { return _expected - _received; }
+
+    /** @brief true se l'errore viene dal body e non dal disco */
+    bool malformed() const { return !_write_failed; }
+    /** @brief File salvati finora */
+    size_t files() const { return _saved.size(); }
+    /** @brief Percorsi dei file salvati dall'ultimo open() */
+    const std::vector<std::string>& saved() const { return _saved; }
+
+    virtual bool partBegin(const std::string& headers);
+    virtual bool partData(const char* data, size_t length);
+    virtual bool partEnd();
+
+private:
+    MultipartParser _parser;
+    BodySink        _file;          ///< Parte in corso (chiuso per i campi del form)
+    std::string     _dir;
+    std::string     _path;          ///< Destinazione della parte in corso
+    size_t          _expected;
+    size_t          _received;
+    std::vector<std::string> _saved;
+    bool            _open;
+    bool            _write_failed;
+};
+
+#endif // MULTIPARTPARSER_HPP
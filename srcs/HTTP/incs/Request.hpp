@@ -6,17 +6,44 @@
 #include "../../Utils/incs/StringUtils.hpp"
 #include "../../Utils/incs/FileHandler.hpp"
 
+#include "../../Utils/incs/Arena.hpp"
+
+#include "RequestParser.hpp"
+
+/**
+ * @brief Header della richiesta: nome e valore copiati nell'arena del client
+ *
+ * Validi fino al reset dell'arena (fine della richiesta): una richiesta
+ * con molti header non fa nessuna allocazione sull'heap.
+ */
+struct RequestHeader {
+    const char* name;
+    size_t      name_length;
+    const char* value;
+    size_t      value_length;
+};
+
 class Request {
 public:
     Request();
     ~Request();
 
     bool isValid() const {
-        return !_method.empty() && !_path.empty() && !raw_data.empty();
+        return !_method.empty() && !_path.empty();
     }
 
-    void parse(const char* data, size_t length);
-    std::string dechunk(const std::string& body);
+    /**
+     * @brief Popola la richiesta dagli offset registrati dal parser
+     * @param buffer Buffer di ricezione su cui ha lavorato il parser
+     * @param parser Parser in stato COMPLETE
+     * @param arena Memoria degli header, da azzerare solo a fine richiesta
+     */
+    void load(const std::string& buffer, const RequestParser& parser, Arena& arena);
+
+    /**
+     * @brief Come load(), ma senza body: basta che gli header siano completi
+     */
+    void loadHeaders(const std::string& buffer, const RequestParser& parser, Arena& arena);
 
     // Setters
     void setHeader(const std::string& key, const std::string& value);
@@ -24,15 +51,14 @@ public:
 
     // Getters
 
-    const std::string& getHeader(const std::string& name) const {
-        std::map<std::string, std::string>::const_iterator it = _headers.find(name);
-        if (it != _headers.end()) return it->second;
-        static const std::string empty;
-        return empty;
+    /** @brief Valore di un header (nome senza distinzione di maiuscole), "" se assente */
+    std::string getHeader(const std::string& name) const {
+        const RequestHeader* header = findHeader(name.c_str());
+        return header ? std::string(header->value, header->value_length) : std::string();
     }
     
     bool hasHeader(const std::string& name) const {
-        return _headers.find(name) != _headers.end();
+        return findHeader(name.c_str()) != NULL;
     }
 
     const std::string& getMethod() const { return _method; }
@@ -41,22 +67,27 @@ public:
 
     const std::string& getQuery() const { return _query; }
     const std::string& getUri() const { return _uri; }
-    const std::map<std::string, std::string>& getHeaders() const { return _headers; }
     const std::string& getBody() const { return _body; }
     size_t getBodySize() const { return _body.size(); }
     const std::string& getQueryString() const { return _query; }
 
-    const std::string& getContentType() const {
-        static std::string empty;
-        std::map<std::string, std::string>::const_iterator it = _headers.find("Content-Type");
-        return (it != _headers.end()) ? it->second : empty;
+    /**
+     * @brief Persistenza della connessione richiesta dal client
+     * @return HTTP/1.1: true salvo "Connection: close";
+     *         HTTP/1.0: true solo con "Connection: keep-alive"
+     */
+    bool wantsKeepAlive() const;
+
+    std::string getContentType() const {
+        return getHeader("Content-Type");
     }
 
 
 
 private:
 
-std::map<std::string, std::string> _headers;
+const RequestHeader* _headers;
+size_t _header_count;
 
 std::string _method;
 std::string _path;
@@ -64,10 +95,9 @@ std::string _version;
     std::string _uri;
     std::string _query;
     std::string _body;
-    std::string raw_data;  // Add this member
 
-    void parseRequestLine(const std::string& line);
-    void parseHeaderLine(const std::string& line);
+    void setTarget(const char* uri, size_t length);
+    const RequestHeader* findHeader(const char* name) const;
 };
 
 #endif // REQUEST_HPP
\ No newline at end of file
@@ -0,0 +1,168 @@
+/**
+ * @file RequestParser.hpp
+ * @brief Parser incrementale (a stati) delle richieste HTTP/1.1
+ *
+ * Il parser esamina ogni byte del buffer di ricezione una sola volta:
+ * ad ogni recv() riprende dallo stato e dall'offset in cui si era fermato.
+ * Non copia stringhe: request line e header vengono memorizzati come
+ * offset nel buffer del client, e Request::load() li materializza una
+ * volta sola quando la richiesta è completa.
+ *
+ * Il body non viene scandito: con Content-Length il parser salta
+ * direttamente alla fine; con Transfer-Encoding: chunked lo decodifica
+ * in place man mano che arriva (ChunkedDecoder), così dopo bodyOffset()
+ * il buffer contiene già il body senza la codifica.
+ */
+
+#ifndef REQUESTPARSER_HPP
+#define REQUESTPARSER_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "ChunkedDecoder.hpp"
+
+/**
+ * @brief Porzione [offset, offset + length) del buffer di ricezione
+ */
+struct Span {
+    size_t offset;
+    size_t length;
+
+    Span() : offset(0), length(0) {}
+};
+
+/**
+ * @brief Header HTTP come coppia di span (nome, valore senza spazi ai bordi)
+ */
+struct HeaderSpan {
+    Span name;
+    Span value;
+};
+
+class RequestParser {
+public:
+    /** @brief Esito di feed() */
+    enum Status {
+        NEED_MORE,  ///< Servono altri byte
+        COMPLETE,   ///< Richiesta completa: [begin(), end()) nel buffer
+        ERROR       ///< Richiesta malformata: vedi errorCode()
+    };
+
+    /** @brief Dimensione massima di request line + header */
+    static const size_t MAX_HEADER_SIZE = 32768;
+
+    RequestParser();
+
+    /**
+     * @brief Riprende il parsing sui nuovi byte del buffer
+     * @param buffer Buffer di ricezione del client (solo append tra le chiamate)
+     * @return NEED_MORE, COMPLETE o ERROR
+     *
+     * Con un body chunked il buffer viene modificato dopo bodyOffset():
+     * i dati decodificati prendono il posto della codifica.
+     */
+    Status feed(std::string& buffer);
+
+    /**
+     * @brief Prepara il parser per una nuova richiesta
+     * @param offset Offset nel buffer da cui inizia la richiesta successiva
+     */
+    void reset(size_t offset = 0);
+
+    /** @brief Limite del body (Content-Length o somma dei chunk) */
+    void setMaxBodySize(size_t max) { _max_body = max; }
+
+    // ==================== RISULTATO ====================
+
+    Span method() const { return _method; }
+    Span target() const { return _target; }
+    Span version() const { return _version; }
+    const std::vector<HeaderSpan>& headers() const { return _headers; }
+
+    /** @brief Offset del primo byte del body */
+    size_t bodyOffset() const { return _body_offset; }
+    /** @brief Byte del body nel buffer (per chunked: decodificati finora) */
+    size_t bodyLength() const { return _end - _body_offset; }
+    /** @brief Offset di inizio della richiesta */
+    size_t begin() const { return _begin; }
+
+    /** @brief true se è arrivato almeno un byte della richiesta corrente */
+    bool started() const { return _pos > _begin; }
+    /** @brief Offset successivo all'ultimo byte della richiesta */
+    size_t end() const { return _end; }
+    /** @brief Primo byte del buffer non ancora esaminato */
+    size_t position() const { return _pos; }
+
+    bool isChunked() const { return _chunked; }
+    bool isComplete() const { return _state == S_DONE; }
+
+    /** @brief Header completi, body ancora in arrivo */
+    bool awaitingBody() const { return _state == S_BODY || _state == S_CHUNKED; }
+    /** @brief Content-Length della richiesta (0 se assente) */
+    size_t contentLength() const { return _content_length; }
+
+    /**
+     * @brief Il body è stato tolto dal buffer (scritto su disco)
+     *
+     * La richiesta termina agli header: bodyLength() diventa 0 e la
+     * successiva inizia a bodyOffset().
+     */
+    void bodyStored();
+
+    /**
+     * @brief Il body chunked decodificato finora è stato tolto dal buffer
+     *
+     * La decodifica riprende da bodyOffset(), dove ora iniziano i byte
+     * non ancora esaminati.
+     */
+    void bodyFlushed();
+
+    /** @brief Codice HTTP da restituire in caso di ERROR (400, 413, 501, 505) */
+    int errorCode() const { return _error; }
+
+private:
+    enum State {
+        S_METHOD,
+        S_TARGET,
+        S_VERSION,
+        S_REQUEST_LINE_LF,
+        S_HEADER_START,
+        S_HEADER_NAME,
+        S_HEADER_VALUE_START,
+        S_HEADER_VALUE,
+        S_HEADER_LF,
+        S_HEADERS_END_LF,
+        S_BODY,
+        S_CHUNKED,
+        S_DONE,
+        S_ERROR
+    };
+
+    State   _state;
+    size_t  _begin;
+    size_t  _pos;
+    size_t  _mark;
+    size_t  _value_end;
+
+    Span                    _method;
+    Span                    _target;
+    Span                    _version;
+    std::vector<HeaderSpan> _headers;
+
+    size_t  _body_offset;
+    size_t  _end;
+    size_t  _content_length;
+    bool    _has_content_length;
+    bool    _chunked;
+    size_t  _max_body;
+    int     _error;
+
+    ChunkedDecoder  _chunks;
+
+    Status fail(int code);
+    int headerDone(const std::string& buffer);
+    int headersComplete(const std::string& buffer);
+    Status decodeChunks(std::string& buffer);
+};
+
+#endif // REQUESTPARSER_HPP
@@ -11,53 +11,121 @@
 /* ************************************************************************** */
 
 
+/**
+ * @file Response.hpp
+ * @brief Costruttore delle risposte HTTP
+ *
+ * Status line e header vengono scritti in un buffer interno di
+ * dimensione fissa (l'oggetto vive sullo stack del gestore): le status
+ * line e gli header più comuni sono costanti precalcolate con la loro
+ * lunghezza, i valori numerici vengono formattati senza stream. Solo
+ * un blocco di header più grande di HEAD_SIZE (Location o Allow molto
+ * lunghi) passa su una std::string.
+ *
+ * Blocco header e body non vengono mai concatenati: gather() li espone
+ * come iovec e la coda di output li invia con un'unica sendmsg().
+ */
+
 #ifndef RESPONSE_HPP
 #define RESPONSE_HPP
 
 #include "../../../incs/webserv.hpp"
 
-#include "../../Utils/incs/MimeTypes.hpp"
-
-class Response
-{
-                public:
-                
-                    // Constructor
-                    Response();
-
-                    // Destructor
-                    ~Response();
-
-
-
-                    // Setters
-
-                    // Set the response status code
-                    void setStatus(int status);
-
-                    // Set a response header
-                    void setHeader(const std::string& key, const std::string& value);
-                
-                    // Set the response body
-                    void setBody(const std::string& _body);
-
-                
-                    // Generate the HTTP response
-                    std::string generate() const;
-
-                private:
-
-                    // Member variables
-
-                    //  Status code
-                    int status;
-
-                    //  Response headers
-                    std::map<std::string, std::string> _headers;
-
-                    //  Response body
-                    std::string _body;
-                    
+class Response {
+public:
+    /** @brief Byte del blocco header tenuti nel buffer interno */
+    static const size_t HEAD_SIZE = 1024;
+
+    /** @brief Spazio richiesto da writeTail() */
+    static const size_t TAIL_SIZE = 64;
+
+    /** @brief Righe di header precalcolate */
+    enum HeaderLine {
+        CONNECTION_KEEP_ALIVE,
+        CONNECTION_CLOSE,
+        CONTENT_TYPE_HTML,
+        CONTENT_TYPE_TEXT,
+        CONTENT_LENGTH_ZERO,
+        TRANSFER_ENCODING_CHUNKED,
+        CACHE_CONTROL_NO_CACHE,
+        SERVER_NAME,
+        CORS_ALLOW_ORIGIN,
+        CORS_ALLOW_METHODS,
+        CORS_ALLOW_HEADERS,
+        CORS_ALLOW_HEADERS_LENGTH,
+        HEADER_LINE_COUNT
+    };
+
+    /** @brief Inizia una risposta con la status line di status */
+    explicit Response(int status = HTTP_OK);
+
+    /** @brief Ricomincia da capo con un altro status (header e body scartati) */
+    void setStatus(int status);
+
+    /** @brief Aggiunge una riga di header precalcolata */
+    void addLine(HeaderLine line);
+
+    /** @brief Aggiunge "name: value" */
+    void addHeader(const char* name, const std::string& value);
+
+    /** @brief Aggiunge "name: value" con un valore numerico */
+    void addHeader(const char* name, size_t value);
+
+    /**
+     * @brief Aggiunge Connection e, per le connessioni persistenti, Keep-Alive
+     * @param timeout_seconds Valore di Keep-Alive: timeout (0: omesso)
+     */
+    void addConnection(bool keep_alive, unsigned long timeout_seconds);
+
+    /** @brief Aggiunge Date con la data in cache di Clock */
+    void addDate();
+
+    /** @brief Aggiunge righe di header già formattate (CRLF compresi) */
+    void addLines(const char* data, size_t length);
+
+    /** @brief Imposta il body e il relativo Content-Length */
+    void setBody(const std::string& body);
+
+    /** @brief Scarta il body lasciando il Content-Length già scritto (risposte a HEAD) */
+    void dropBody() { _body.clear(); }
+
+    /** @brief Body della risposta, da riempire sul posto */
+    std::string& body() { return _body; }
+
+    /** @brief Blocco header scritto finora (senza la riga vuota finale) */
+    const char* headData() const { return _spill.empty() ? _head : _spill.data(); }
+    size_t headLength() const { return _spill.empty() ? _length : _spill.size(); }
+
+    /**
+     * @brief Chiude il blocco header e lo espone con il body come iovec
+     * @param iov Almeno 2 elementi
+     * @return Elementi usati (il body è omesso se vuoto)
+     */
+    size_t gather(struct iovec* iov);
+
+    /**
+     * @brief Scrive la parte variabile di una risposta in cache
+     * @param out Almeno TAIL_SIZE byte
+     * @return Byte scritti: Connection, Date e la riga vuota finale
+     */
+    static size_t writeTail(char* out, bool keep_alive);
+
+    /** @brief Reason phrase standard di uno status ("Unknown" se sconosciuto) */
+    static const char* reason(int status);
+
+private:
+    char        _head[HEAD_SIZE];
+    size_t      _length;
+    std::string _spill;     ///< Blocco header oltre HEAD_SIZE (di solito vuoto)
+    std::string _body;
+    bool        _closed;    ///< Riga vuota finale già aggiunta
+
+    void append(const char* data, size_t length);
+    void appendNumber(size_t value);
+
+    // Il buffer interno è grande: passato per riferimento, non copiato
+    Response(const Response&);
+    Response& operator=(const Response&);
 };
 
 #endif // RESPONSE_HPP
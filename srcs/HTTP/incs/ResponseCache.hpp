@@ -0,0 +1,100 @@
+/**
+ * @file ResponseCache.hpp
+ * @brief Cache in memoria delle risposte per i file statici piccoli
+ *
+ * Per i file sotto la soglia configurata conserva il blocco di header
+ * già serializzato (status line, Content-Type, Content-Length, Server)
+ * e il body. Una hit accoda i due buffer condivisi più la sola parte
+ * variabile (Connection, Date): niente costruzione degli header, niente
+ * sendfile() e una sola sendmsg() per l'intera risposta.
+ *
+ * L'eviction è LRU entro un budget globale di byte. La validità segue
+ * la OpenFileCache: se inode, dimensione o mtime cambiano l'entry viene
+ * scartata al primo accesso.
+ */
+
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "../../Utils/incs/OpenFileCache.hpp"
+#include "../../Utils/incs/SharedBuffer.hpp"
+
+/**
+ * @brief Risposta in cache: header fissi e body condivisi
+ */
+struct CachedResponse {
+    SharedBuffer*                    head;
+    SharedBuffer*                    body;
+    time_t                           mtime;
+    off_t                            size;
+    ino_t                            ino;
+    dev_t                            dev;
+    size_t                           bytes;
+    std::list<std::string>::iterator lru;
+
+    CachedResponse() : head(NULL), body(NULL), mtime(0), size(0), ino(0), dev(0), bytes(0), lru() {}
+};
+
+class ResponseCache {
+public:
+    ResponseCache();
+    ~ResponseCache();
+
+    /**
+     * @brief Imposta budget e soglia
+     * @param budget Byte totali in memoria (0 = cache disattivata)
+     * @param max_file Dimensione massima di un file da mettere in cache
+     */
+    void configure(size_t budget, size_t max_file);
+
+    /** @brief true se il file rientra nella soglia e nel budget */
+    bool isCacheable(const OpenFileInfo& file) const;
+
+    /**
+     * @brief Cerca la risposta per un percorso
+     * @param file Metadati correnti (dalla OpenFileCache) per validare l'entry
+     * @return Entry valida o NULL (le entry obsolete vengono scartate)
+     */
+    const CachedResponse* find(const std::string& path, const OpenFileInfo& file);
+
+    /**
+     * @brief Inserisce una risposta, liberando le meno usate se serve
+     * @param body Contenuto del file (viene scambiato, non copiato)
+     */
+    const CachedResponse* insert(const std::string& path, const OpenFileInfo& file,
+                                 const std::string& head, std::string& body);
+
+    /** @brief Rimuove un percorso e quelli al suo interno (dopo upload o DELETE) */
+    void invalidate(const std::string& path);
+
+    /** @brief Rimuove tutte le entry (gli invii in corso restano validi) */
+    void clear();
+
+    // ==================== STATISTICHE ====================
+
+    size_t hits() const { return _hits; }
+    size_t misses() const { return _misses; }
+    size_t size() const { return _entries.size(); }
+    size_t memoryUsed() const { return _used; }
+    size_t budget() const { return _budget; }
+
+private:
+    typedef std::map<std::string, CachedResponse> EntryMap;
+
+    EntryMap                _entries;
+    std::list<std::string>  _lru;       ///< In testa il percorso usato più di recente
+    size_t                  _budget;
+    size_t                  _max_file;
+    size_t                  _used;
+    size_t                  _hits;
+    size_t                  _misses;
+
+    void drop(EntryMap::iterator it);
+
+    ResponseCache(const ResponseCache&);
+    ResponseCache& operator=(const ResponseCache&);
+};
+
+#endif // RESPONSECACHE_HPP
@@ -0,0 +1,168 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/BodySink.hpp"
+
+BodySink::BodySink() : _fd(-1), _path(), _expected(0), _received(0), _failed(false), _pipe_size(0) {
+    _pipe[0] = -1;
+    _pipe[1] = -1;
+}
+
+BodySink::BodySink(const BodySink&) : _fd(-1), _path(), _expected(0), _received(0), _failed(false),
+    _pipe_size(0) {
+    _pipe[0] = -1;
+    _pipe[1] = -1;
+}
+
+BodySink& BodySink::operator=(const BodySink& other) {
+    if (this != &other)
+        discard();
+    return *this;
+}
+
+BodySink::~BodySink() {
+    discard();
+}
+
+bool BodySink::open(const std::string& dir, size_t expected) {
+    discard();
+
+    std::string pattern = dir;
+    if (pattern.empty() || pattern[pattern.size() - 1] != '/')
+        pattern += '/';
+    pattern += ".upload-XXXXXX";
+
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    int fd = mkstemp(&name[0]);
+    if (fd == -1) {
+        std::cerr << "Cannot create upload file in " << dir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    // mkstemp() crea il file 0600: stessi permessi degli altri upload
+    fchmod(fd, 0644);
+
+    _fd = fd;
+    _path = &name[0];
+    _expected = expected;
+    _received = 0;
+    _failed = false;
+    return true;
+}
+
+bool BodySink::write(const char* data, size_t length) {
+    // File regolare: una write() corta significa disco pieno o errore
+    while (length > 0) {
+        ssize_t written = ::write(_fd, data, length);
+        if (written <= 0) {
+            std::cerr << "Write failed on upload file " << _path << std::endl;
+            _failed = true;
+            return false;
+        }
+        data += written;
+        length -= written;
+        _received += written;
+    }
+    return true;
+}
+
+ssize_t BodySink::receive(int socket_fd) {
+    size_t length = remaining();
+
+#ifdef __linux__
+    if (_pipe[0] != -1 || openPipe()) {
+        length = std::min(length, _pipe_size);
+        // La pipe è vuota a ogni chiamata: il primo splice() non si blocca
+        ssize_t moved = splice(socket_fd, NULL, _pipe[1], NULL, length, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (moved <= 0)
+            return moved;
+
+        // Pipe -> file: scrittura su disco, la svuota sempre del tutto
+        size_t pending = moved;
+        while (pending > 0) {
+            ssize_t written = splice(_pipe[0], NULL, _fd, NULL, pending, SPLICE_F_MOVE);
+            if (written <= 0) {
+                std::cerr << "splice() failed on upload file " << _path << std::endl;
+                _failed = true;
+                return -1;
+            }
+            pending -= written;
+        }
+        _received += moved;
+        return moved;
+    }
+#endif
+    return receiveCopy(socket_fd, length);
+}
+
+/**
+ * @brief Ripiego senza splice(): recv() su un buffer da RECEIVE_SIZE e write() sul file
+ */
+ssize_t BodySink::receiveCopy(int socket_fd, size_t length) {
+    static std::vector<char> buffer(RECEIVE_SIZE);
+
+    ssize_t received = recv(socket_fd, &buffer[0], std::min(length, buffer.size()), 0);
+    if (received <= 0)
+        return received;
+    if (!write(&buffer[0], received))
+        return -1;
+    return received;
+}
+
+bool BodySink::openPipe() {
+#ifdef __linux__
+    if (pipe(_pipe) == -1) {
+        _pipe[0] = -1;
+        _pipe[1] = -1;
+        return false;
+    }
+    fcntl(_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(_pipe[1], F_SETFD, FD_CLOEXEC);
+    // Pipe più grande del default (64 KB): meno splice() per megabyte;
+    // il limite per utenti non privilegiati è /proc/sys/fs/pipe-max-size
+    int size = fcntl(_pipe[1], F_SETPIPE_SZ, static_cast<int>(RECEIVE_SIZE));
+    if (size <= 0)
+        size = fcntl(_pipe[1], F_GETPIPE_SZ);
+    _pipe_size = (size > 0) ? static_cast<size_t>(size) : 65536;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BodySink::closePipe() {
+    if (_pipe[0] == -1)
+        return;
+    close(_pipe[0]);
+    close(_pipe[1]);
+    _pipe[0] = -1;
+    _pipe[1] = -1;
+}
+
+bool BodySink::commit(const std::string& path) {
+    if (_fd == -1)
+        return false;
+    closePipe();
+    close(_fd);
+    _fd = -1;
+    if (rename(_path.c_str(), path.c_str()) == -1) {
+        std::cerr << "Cannot rename " << _path << " to " << path << ": " << strerror(errno) << std::endl;
+        unlink(_path.c_str());
+        _path.clear();
+        return false;
+    }
+    _path.clear();
+    return true;
+}
+
+void BodySink::discard() {
+    if (_fd == -1)
+        return;
+    closePipe();
+    close(_fd);
+    unlink(_path.c_str());
+    _fd = -1;
+    _path.clear();
+    _expected = 0;
+    _received = 0;
+}
@@ -0,0 +1,156 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/ChunkedDecoder.hpp"
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+ChunkedDecoder::ChunkedDecoder() {
+    reset(DEFAULT_MAX_BODY_SIZE);
+}
+
+void ChunkedDecoder::reset(size_t max_body) {
+    _state = S_SIZE;
+    _remaining = 0;
+    _digits = 0;
+    _line = 0;
+    _total = 0;
+    _max_body = max_body;
+    _error = 0;
+}
+
+void ChunkedDecoder::fail(int code) {
+    _error = code;
+    _state = S_ERROR;
+}
+
+ChunkedDecoder::Status ChunkedDecoder::decode(const char* data, size_t length, char* out,
+                                              size_t& consumed, size_t& produced) {
+    size_t i = 0;
+    produced = 0;
+
+    while (i < length && _state != S_DONE && _state != S_ERROR) {
+        char c = data[i];
+        switch (_state) {
+
+        case S_SIZE: {
+            int digit = hexValue(c);
+            if (digit >= 0) {
+                if (_remaining > (static_cast<size_t>(-1) >> 4)) {
+                    fail(HTTP_REQUEST_ENTITY_TOO_LARGE);
+                    break;
+                }
+                _remaining = (_remaining << 4) | static_cast<size_t>(digit);
+                ++_digits;
+                break;
+            }
+            if (_digits == 0)
+                fail(HTTP_BAD_REQUEST);
+            else if (c == '\r')
+                _state = S_SIZE_LF;
+            else if (c == ';' || c == ' ' || c == '\t') {
+                _line = 0;
+                _state = S_EXTENSION;
+            } else if (c == '\n') {
+                _state = S_SIZE_LF;     // LF senza CR
+                continue;
+            } else
+                fail(HTTP_BAD_REQUEST);
+            break;
+        }
+
+        case S_EXTENSION:
+            if (c == '\r')
+                _state = S_SIZE_LF;
+            else if (c == '\n') {
+                _state = S_SIZE_LF;
+                continue;
+            } else if (++_line >= MAX_LINE_SIZE)
+                fail(HTTP_BAD_REQUEST);
+            break;
+
+        case S_SIZE_LF:
+            if (c != '\n') {
+                fail(HTTP_BAD_REQUEST);
+                break;
+            }
+            if (_remaining == 0) {
+                _state = S_TRAILER_START;
+                break;
+            }
+            // Limite controllato prima di ricevere i dati del chunk
+            if (_remaining > _max_body - _total) {
+                fail(HTTP_REQUEST_ENTITY_TOO_LARGE);
+                break;
+            }
+            _total += _remaining;
+            _state = S_DATA;
+            break;
+
+        case S_DATA: {
+            size_t available = std::min(_remaining, length - i);
+            memmove(out + produced, data + i, available);
+            produced += available;
+            i += available;
+            _remaining -= available;
+            if (_remaining == 0)
+                _state = S_DATA_CR;
+            continue;
+        }
+
+        case S_DATA_CR:
+            if (c == '\r') {
+                _state = S_DATA_LF;
+                break;
+            }
+            // fallthrough - LF senza CR
+        case S_DATA_LF:
+            if (c != '\n') {
+                fail(HTTP_BAD_REQUEST);
+                break;
+            }
+            _digits = 0;
+            _state = S_SIZE;
+            break;
+
+        case S_TRAILER_START:
+            if (c == '\r')
+                _state = S_TRAILER_END_LF;
+            else if (c == '\n')
+                _state = S_DONE;
+            else {
+                _line = 0;
+                _state = S_TRAILER_LINE;
+            }
+            break;
+
+        case S_TRAILER_LINE:
+            if (c == '\n')
+                _state = S_TRAILER_START;
+            else if (++_line >= MAX_LINE_SIZE)
+                fail(HTTP_BAD_REQUEST);
+            break;
+
+        case S_TRAILER_END_LF:
+            if (c != '\n')
+                fail(HTTP_BAD_REQUEST);
+            else
+                _state = S_DONE;
+            break;
+
+        case S_DONE:
+        case S_ERROR:
+            break;
+        }
+        ++i;
+    }
+
+    consumed = i;
+    if (_state == S_ERROR)
+        return ERROR;
+    return (_state == S_DONE) ? COMPLETE : NEED_MORE;
+}
@@ -0,0 +1,74 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/DirectoryListing.hpp"
+#include "../../Utils/incs/FileHandler.hpp"
+
+DirectoryListing::DirectoryListing() : _dir(NULL), _path(), _request_path(), _state(DONE) {}
+
+DirectoryListing::~DirectoryListing() {
+    close();
+}
+
+bool DirectoryListing::open(const std::string& path, const std::string& request_path) {
+    close();
+    _dir = opendir(path.c_str());
+    if (!_dir)
+        return false;
+    _path = path;
+    _request_path = request_path;
+    _state = HEAD;
+    return true;
+}
+
+void DirectoryListing::close() {
+    if (_dir)
+        closedir(_dir);
+    _dir = NULL;
+}
+
+void DirectoryListing::next(std::string& out) {
+    if (_state == HEAD) {
+        out += "<!DOCTYPE html>\n<html>\n<head>\n"
+               "<title>Directory Listing</title>\n"
+               "<style>\n"
+               "body { font-family: Arial, sans-serif; margin: 20px; }\n"
+               "h1 { color: #333; }\n"
+               ".file-list { list-style: none; padding: 0; }\n"
+               ".file-list li { margin: 10px 0; padding: 10px; background: #f5f5f5; border-radius: 5px; }\n"
+               ".file-list a { color: #007bff; text-decoration: none; }\n"
+               ".file-list a:hover { text-decoration: underline; }\n"
+               "</style>\n"
+               "</head>\n<body>\n";
+        out += "<h1>Directory Listing for " + _request_path + "</h1>\n";
+        out += "<ul class='file-list'>\n";
+
+        // Link alla directory padre se non siamo nella root
+        if (_request_path != "/") {
+            std::string parent = _request_path.substr(0, _request_path.rfind('/', _request_path.length() - 2) + 1);
+            if (parent.empty())
+                parent = "/";
+            out += "<li><a href=\"" + parent + "\">[DIR] Parent Directory</a></li>\n";
+        }
+        _state = ENTRIES;
+    }
+
+    size_t limit = out.size() + CHUNK_SIZE;
+    while (_state == ENTRIES && out.size() < limit) {
+        struct dirent* entry = readdir(_dir);
+        if (!entry) {
+            out += "</ul>\n</body>\n</html>";
+            close();
+            _state = DONE;
+            break;
+        }
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+
+        std::string link = _request_path + name;
+        if (FileHandler::isDirectory(_path + "/" + name))
+            out += "<li><a href=\"" + link + "/\">[DIR] " + name + "/</a></li>\n";
+        else
+            out += "<li><a href=\"" + link + "\">" + name + "</a></li>\n";
+    }
+}
@@ -0,0 +1,286 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/MultipartParser.hpp"
+#include "../../Utils/incs/FileHandler.hpp"
+
+// ==================== PARSER ====================
+
+MultipartParser::MultipartParser() : _state(S_ERROR), _delimiter(), _tail(), _headers(),
+    _in_part(false), _handler(NULL) {
+    for (size_t i = 0; i < 256; ++i)
+        _skip[i] = 0;
+}
+
+void MultipartParser::reset(const std::string& boundary, MultipartHandler* handler) {
+    _delimiter = "\r\n--" + boundary;
+    _handler = handler;
+    _headers.clear();
+    _in_part = false;
+    // Il primo delimitatore non è preceduto da CRLF: si finge che lo sia
+    _tail = "\r\n";
+    _state = boundary.empty() ? S_ERROR : S_SEARCH;
+
+    size_t m = _delimiter.size();
+    for (size_t i = 0; i < 256; ++i)
+        _skip[i] = m;
+    for (size_t i = 0; i + 1 < m; ++i)
+        _skip[static_cast<unsigned char>(_delimiter[i])] = m - 1 - i;
+}
+
+/**
+ * @brief Boyer-Moore-Horspool: prima occorrenza del delimitatore
+ * @return Offset dell'occorrenza, length se assente
+ */
+size_t MultipartParser::find(const char* data, size_t length) const {
+    size_t m = _delimiter.size();
+    if (length < m)
+        return length;
+
+    const char* pattern = _delimiter.data();
+    size_t i = 0;
+    while (i <= length - m) {
+        size_t j = m - 1;
+        while (data[i + j] == pattern[j]) {
+            if (j == 0)
+                return i;
+            --j;
+        }
+        i += _skip[static_cast<unsigned char>(data[i + m - 1])];
+    }
+    return length;
+}
+
+bool MultipartParser::emit(const char* data, size_t length) {
+    if (!_in_part || length == 0)
+        return true;
+    return _handler->partData(data, length);
+}
+
+bool MultipartParser::boundaryFound() {
+    if (_in_part) {
+        _in_part = false;
+        if (!_handler->partEnd())
+            return false;
+    }
+    _state = S_BOUNDARY_END;
+    return true;
+}
+
+bool MultipartParser::fail() {
+    _state = S_ERROR;
+    return false;
+}
+
+/**
+ * @brief Cerca il delimitatore nel blocco, emettendo il contenuto che lo precede
+ * @return false se l'handler rifiuta i dati
+ *
+ * Al ritorno data/length puntano ai byte dopo il delimitatore, oppure
+ * length è 0 e gli ultimi byte del blocco sono in _tail.
+ */
+bool MultipartParser::search(const char*& data, size_t& length) {
+    size_t m = _delimiter.size();
+
+    if (!_tail.empty()) {
+        // Delimitatore a cavallo tra il blocco precedente e questo: basta
+        // guardare _tail più i primi m - 1 byte del blocco
+        size_t take = std::min(length, m - 1);
+        std::string window(_tail);
+        window.append(data, take);
+        size_t found = find(window.data(), window.size());
+        if (found < window.size()) {
+            size_t used = found + m - _tail.size();
+            if (!emit(window.data(), found))
+                return false;
+            _tail.clear();
+            data += used;
+            length -= used;
+            return boundaryFound();
+        }
+        if (take < m - 1) {
+            // Blocco più corto del delimitatore: restano in sospeso gli ultimi m - 1 byte
+            size_t keep = std::min(window.size(), m - 1);
+            if (!emit(window.data(), window.size() - keep))
+                return false;
+            _tail.assign(window, window.size() - keep, keep);
+            length = 0;
+            return true;
+        }
+        if (!emit(_tail.data(), _tail.size()))
+            return false;
+        _tail.clear();
+    }
+
+    size_t found = find(data, length);
+    if (found < length) {
+        if (!emit(data, found))
+            return false;
+        data += found + m;
+        length -= found + m;
+        return boundaryFound();
+    }
+
+    size_t keep = std::min(length, m - 1);
+    if (!emit(data, length - keep))
+        return false;
+    _tail.assign(data + length - keep, keep);
+    length = 0;
+    return true;
+}
+
+bool MultipartParser::feed(const char* data, size_t length) {
+    while (length > 0) {
+        switch (_state) {
+        case S_SEARCH:
+            if (!search(data, length))
+                return fail();
+            continue;
+
+        // Dopo "--boundary": "--" chiude il body, CRLF apre una parte
+        // (eventuali spazi in mezzo sono padding ammesso dalla RFC 2046)
+        case S_BOUNDARY_END:
+            if (*data == '-')
+                _state = S_CLOSE_DASH;
+            else if (*data == '\r')
+                _state = S_BOUNDARY_LF;
+            else if (*data != ' ' && *data != '\t')
+                return fail();
+            break;
+
+        case S_BOUNDARY_LF:
+            if (*data != '\n')
+                return fail();
+            _headers.clear();
+            _state = S_HEADERS;
+            break;
+
+        case S_CLOSE_DASH:
+            if (*data != '-')
+                return fail();
+            _state = S_DONE;
+            break;
+
+        case S_HEADERS: {
+            _headers += *data;
+            size_t size = _headers.size();
+            if (size == 2 && _headers == "\r\n") {
+                _headers.clear();
+            } else if (size >= 4 && _headers.compare(size - 4, 4, "\r\n\r\n") == 0) {
+                _headers.erase(size - 4);
+            } else {
+                if (size > MAX_PART_HEADER_SIZE)
+                    return fail();
+                break;
+            }
+            _in_part = true;
+            _state = S_SEARCH;
+            if (!_handler->partBegin(_headers))
+                return fail();
+            break;
+        }
+
+        case S_DONE:
+            return true;
+
+        case S_ERROR:
+            return false;
+        }
+        ++data;
+        --length;
+    }
+    return _state != S_ERROR;
+}
+
+// ==================== UPLOAD SU DISCO ====================
+
+MultipartUpload::MultipartUpload() : _parser(), _file(), _dir(), _path(),
+    _expected(0), _received(0), _saved(), _open(false), _write_failed(false) {}
+
+MultipartUpload::MultipartUpload(const MultipartUpload&) : MultipartHandler(), _parser(), _file(),
+    _dir(), _path(), _expected(0), _received(0), _saved(), _open(false), _write_failed(false) {}
+
+MultipartUpload& MultipartUpload::operator=(const MultipartUpload& other) {
+    if (this != &other)
+        discard();
+    return *this;
+}
+
+MultipartUpload::~MultipartUpload() {
+    discard();
+}
+
+void MultipartUpload::open(const std::string& dir, const std::string& boundary, size_t expected) {
+    discard();
+    _parser.reset(boundary, this);
+    _dir = dir;
+    _expected = expected;
+    _received = 0;
+    _saved.clear();
+    _open = true;
+    _write_failed = false;
+}
+
+bool MultipartUpload::write(const char* data, size_t length) {
+    _received += length;
+    return _parser.feed(data, length);
+}
+
+bool MultipartUpload::finish() {
+    bool ok = _parser.isComplete();
+    discard();
+    return ok;
+}
+
+void MultipartUpload::discard() {
+    _file.discard();
+    _path.clear();
+    _open = false;
+}
+
+/**
+ * @brief Nuova parte: se ha un filename, apre il file temporaneo accanto alla destinazione
+ */
+bool MultipartUpload::partBegin(const std::string& headers) {
+    _path.clear();
+
+    size_t disposition = headers.find("Content-Disposition:");
+    if (disposition == std::string::npos)
+        return true;
+    size_t start = headers.find("filename=\"", disposition);
+    if (start == std::string::npos)
+        return true;
+    start += 10;
+    size_t end = headers.find('"', start);
+    if (end == std::string::npos || end == start)
+        return true;
+
+    _path = FileHandler::sanitizePath(_dir + "/" + headers.substr(start, end - start));
+    std::string dir = _path.substr(0, _path.find_last_of('/'));
+    if (!FileHandler::createDirectory(dir) || !_file.open(dir, 0)) {
+        _write_failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool MultipartUpload::partData(const char* data, size_t length) {
+    if (!_file.isOpen())
+        return true;
+    if (!_file.write(data, length)) {
+        _write_failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool MultipartUpload::partEnd() {
+    if (!_file.isOpen())
+        return true;
+    if (!_file.commit(_path)) {
+        _write_failed = true;
+        return false;
+    }
+    std::cout << "SUCCESS: File '" << _path << "' saved successfully" << std::endl;
+    _saved.push_back(_path);
+    return true;
+}
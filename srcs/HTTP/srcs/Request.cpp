@@ -18,7 +18,7 @@
 
 
 // Constructor
-Request::Request()
+Request::Request() : _headers(NULL), _header_count(0)
 {
     // No print in constructor
 }
@@ -33,109 +33,77 @@ Request::~Request()
 
 
 
-std::string Request::dechunk(const std::string& body) {
-    std::string result;
-    size_t pos = 0;
+void Request::load(const std::string& buffer, const RequestParser& parser, Arena& arena) {
+    loadHeaders(buffer, parser, arena);
 
-    while (pos < body.size()) {
-        size_t chunk_size_end = body.find("\r\n", pos);
-        if (chunk_size_end == std::string::npos) break;
-
-        // Estrai dimensione chunk
-        std::string chunk_size_str = body.substr(pos, chunk_size_end - pos);
-        unsigned int chunk_size;
-        std::istringstream iss(chunk_size_str);
-        iss >> std::hex >> chunk_size;
-
-        if (chunk_size == 0) break; // Chunk finale
-        
-        // Salta "\r\n" e leggi i dati
-        pos = chunk_size_end + 2;
-        result += body.substr(pos, chunk_size);
-        pos += chunk_size + 2; // Salta "\r\n" dopo i dati
-    }
-
-    return result;
+    // Body già decodificato dal parser anche se chunked
+    _body.assign(buffer, parser.bodyOffset(), parser.bodyLength());
 }
 
-
-
-void Request::parse(const char* data, size_t length) {
-    raw_data.append(data, length);
-
-    // Separazione header/body
-    size_t header_end = raw_data.find("\r\n\r\n");
-    if (header_end == std::string::npos) return;
-
-    // Parsing headers
-    std::istringstream headers_stream(raw_data.substr(0, header_end));
-    std::string header_line;
-    while (std::getline(headers_stream, header_line)) {
-        parseHeaderLine(header_line);
+void Request::loadHeaders(const std::string& buffer, const RequestParser& parser, Arena& arena) {
+    _method.assign(buffer, parser.method().offset, parser.method().length);
+    _version.assign(buffer, parser.version().offset, parser.version().length);
+    setTarget(buffer.data() + parser.target().offset, parser.target().length);
+
+    // Nomi e valori copiati nell'arena: il buffer di ricezione può essere
+    // riallocato o compattato mentre la richiesta è ancora in uso
+    const std::vector<HeaderSpan>& spans = parser.headers();
+    RequestHeader* headers = static_cast<RequestHeader*>(arena.allocate(spans.size() * sizeof(RequestHeader)));
+    const char* data = buffer.data();
+    for (size_t i = 0; i < spans.size(); ++i) {
+        headers[i].name = arena.copy(data + spans[i].name.offset, spans[i].name.length);
+        headers[i].name_length = spans[i].name.length;
+        headers[i].value = arena.copy(data + spans[i].value.offset, spans[i].value.length);
+        headers[i].value_length = spans[i].value.length;
     }
+    _headers = headers;
+    _header_count = spans.size();
+}
 
-    // Estrazione body
-    _body = raw_data.substr(header_end + 4);
-
-    // Gestione chunked encoding
-    if (getHeader("Transfer-Encoding") == "chunked") {
-        _body = dechunk(_body);
+const RequestHeader* Request::findHeader(const char* name) const {
+    size_t length = strlen(name);
+    for (size_t i = 0; i < _header_count; ++i) {
+        if (_headers[i].name_length == length && strcasecmp(_headers[i].name, name) == 0)
+            return &_headers[i];
     }
-
-    // Parsing request line (METODO/PATH/VERSIONE)
-    size_t first_line_end = raw_data.find("\r\n");
-    parseRequestLine(raw_data.substr(0, first_line_end));
+    return NULL;
 }
 
 
-// Parse a header line
-void Request::parseHeaderLine(const std::string& line)
-{
-
-    size_t colon_pos = line.find(':');
-
-    if (colon_pos != std::string::npos)
-    {
-
-        std::string key = line.substr(0, colon_pos);
+void Request::setTarget(const char* uri, size_t length) {
+    // assign() riusa la capacità già presente: nessuna allocazione per
+    // URI non più lunghi di quelli delle richieste precedenti
+    _uri.assign(uri, length);
 
-        std::string value = line.substr(colon_pos + 1);
-
-        
-        // Trim leading/trailing whitespace
-        key.erase(0, key.find_first_not_of(" \t\r\n")); // Erase leading whitespace
-        key.erase(key.find_last_not_of(" \t\r\n") + 1); // Erase trailing whitespace
-        value.erase(0, value.find_first_not_of(" \t\r\n")); // Erase leading whitespace
-        value.erase(value.find_last_not_of(" \t\r\n") + 1); // Erase trailing whitespace
-        
-        // Add the header to the map
-        _headers[key] = value;
-        
+    // Parse query parameters
+    size_t query_pos = _uri.find('?');
+    if (query_pos != std::string::npos) {
+        _path.assign(_uri, 0, query_pos);
+        _query.assign(_uri, query_pos + 1, std::string::npos);
+    } else {
+        _path = _uri;
+        _query.clear();
     }
+    FileHandler::sanitizePathInPlace(_path);
+    FileHandler::sanitizePathInPlace(_uri);
 }
 
 
-void Request::parseRequestLine(const std::string& line) {
-    size_t method_end = line.find(' ');
-    size_t path_end = line.find(' ', method_end + 1);
-    size_t version_end = line.find("\r\n");
-
-    if (method_end != std::string::npos && path_end != std::string::npos) {
-        _method = line.substr(0, method_end);
-        _uri = line.substr(method_end + 1, path_end - method_end - 1);
-        _version = line.substr(path_end + 1, version_end - path_end - 1);
-
-        // Parse query parameters
-        size_t query_pos = _uri.find('?');
-        if (query_pos != std::string::npos) {
-            _path = _uri.substr(0, query_pos);
-            _query = _uri.substr(query_pos + 1);
-        } else {
-            _path = _uri;
-        }
+static bool containsToken(const char* value, size_t length, const char* token) {
+    size_t token_length = strlen(token);
+    for (size_t i = 0; i + token_length <= length; ++i) {
+        if (strncasecmp(value + i, token, token_length) == 0)
+            return true;
     }
-    _path = FileHandler::sanitizePath(_path);
-    _uri = FileHandler::sanitizePath(_uri);
+    return false;
 }
 
+bool Request::wantsKeepAlive() const {
+    const RequestHeader* connection = findHeader("Connection");
+    const char* value = connection ? connection->value : "";
+    size_t length = connection ? connection->value_length : 0;
 
+    if (_version == "HTTP/1.0")
+        return containsToken(value, length, "keep-alive");
+    return !containsToken(value, length, "close");
+}
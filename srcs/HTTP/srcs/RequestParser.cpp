@@ -0,0 +1,344 @@
+#include "../../../incs/webserv.hpp"
+
+#include "RequestParser.hpp"
+
+// ==================== HELPER ====================
+
+/** @brief Caratteri ammessi in metodo e nome header (token RFC 9110) */
+static bool isTokenChar(char c) {
+    if (isalnum(static_cast<unsigned char>(c)))
+        return true;
+    switch (c) {
+        case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+        case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool isControlChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return (u < 0x20 && c != '\t') || u == 0x7f;
+}
+
+/** @brief Confronto case-insensitive tra uno span del buffer e una stringa */
+static bool spanEquals(const std::string& buffer, const Span& span, const char* literal) {
+    size_t len = strlen(literal);
+    if (span.length != len)
+        return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (tolower(static_cast<unsigned char>(buffer[span.offset + i])) != tolower(static_cast<unsigned char>(literal[i])))
+            return false;
+    }
+    return true;
+}
+
+// ==================== COSTRUZIONE ====================
+
+RequestParser::RequestParser() : _max_body(DEFAULT_MAX_BODY_SIZE) {
+    reset(0);
+}
+
+void RequestParser::reset(size_t offset) {
+    _state = S_METHOD;
+    _begin = offset;
+    _pos = offset;
+    _mark = offset;
+    _value_end = offset;
+    _method = Span();
+    _target = Span();
+    _version = Span();
+    _headers.clear();
+    _body_offset = offset;
+    _end = offset;
+    _content_length = 0;
+    _has_content_length = false;
+    _chunked = false;
+    _error = 0;
+}
+
+void RequestParser::bodyStored() {
+    _pos = _end = _body_offset;
+    _state = S_DONE;
+}
+
+void RequestParser::bodyFlushed() {
+    _pos = _end = _body_offset;
+}
+
+RequestParser::Status RequestParser::fail(int code) {
+    _state = S_ERROR;
+    _error = code;
+    return ERROR;
+}
+
+// ==================== HEADER NOTEVOLI ====================
+
+/**
+ * @brief Chiamata alla fine di ogni riga di header
+ * @return 0 se valido, altrimenti il codice HTTP di errore
+ *
+ * Solo Content-Length e Transfer-Encoding influenzano il framing:
+ * gli altri header restano semplici span.
+ */
+int RequestParser::headerDone(const std::string& buffer) {
+    const HeaderSpan& header = _headers.back();
+
+    if (spanEquals(buffer, header.name, "Content-Length")) {
+        if (header.value.length == 0)
+            return HTTP_BAD_REQUEST;
+        size_t value = 0;
+        for (size_t i = 0; i < header.value.length; ++i) {
+            char c = buffer[header.value.offset + i];
+            if (!isdigit(static_cast<unsigned char>(c)))
+                return HTTP_BAD_REQUEST;
+            if (value > (static_cast<size_t>(-1) - 9) / 10)
+                return HTTP_REQUEST_ENTITY_TOO_LARGE;
+            value = value * 10 + (c - '0');
+        }
+        if (_has_content_length && value != _content_length)
+            return HTTP_BAD_REQUEST;
+        if (value > _max_body)
+            return HTTP_REQUEST_ENTITY_TOO_LARGE;
+        _content_length = value;
+        _has_content_length = true;
+    } else if (spanEquals(buffer, header.name, "Transfer-Encoding")) {
+        // L'unica codifica supportata è chunked da sola: con altre codifiche
+        // (es. "gzip, chunked") il body andrebbe decodificato anche dopo il
+        // dechunk, e un secondo header equivale a una lista
+        if (_chunked || !spanEquals(buffer, header.value, "chunked"))
+            return HTTP_NOT_IMPLEMENTED;
+        _chunked = true;
+    }
+    return 0;
+}
+
+/**
+ * @brief Chiamata dopo la riga vuota che chiude gli header
+ * @return 0 se valido, altrimenti il codice HTTP di errore
+ */
+int RequestParser::headersComplete(const std::string& buffer) {
+    if (_version.length != 8 || buffer.compare(_version.offset, 7, "HTTP/1.") != 0
+        || !isdigit(static_cast<unsigned char>(buffer[_version.offset + 7])))
+        return HTTP_VERSION_NOT_SUPPORTED;
+
+    // Transfer-Encoding insieme a Content-Length: i due header danno
+    // confini diversi al body e con il pipelining il resto verrebbe letto
+    // come richiesta successiva (request smuggling). Rifiutata (RFC 9112 6.1)
+    if (_chunked && _has_content_length)
+        return HTTP_BAD_REQUEST;
+
+    _body_offset = _pos;
+    if (_chunked) {
+        _chunks.reset(_max_body);
+        _end = _pos;
+        _state = S_CHUNKED;
+    } else if (_content_length > 0) {
+        _state = S_BODY;
+    } else {
+        _end = _pos;
+        _state = S_DONE;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodifica i chunk arrivati, compattando il body nel buffer
+ *
+ * I dati decodificati vengono scritti a partire da _end; i byte di
+ * codifica che restano tra i dati e l'input non ancora letto vengono
+ * tolti, così [bodyOffset(), end()) è sempre il body decodificato e
+ * dopo end() iniziano i byte da esaminare (o la richiesta successiva).
+ */
+RequestParser::Status RequestParser::decodeChunks(std::string& buffer) {
+    size_t consumed = 0;
+    size_t produced = 0;
+    ChunkedDecoder::Status status = _chunks.decode(buffer.data() + _pos, buffer.size() - _pos,
+                                                   &buffer[_end], consumed, produced);
+    if (status == ChunkedDecoder::ERROR)
+        return fail(_chunks.errorCode());
+
+    size_t gap = (_pos + consumed) - (_end + produced);
+    _end += produced;
+    if (gap > 0)
+        buffer.erase(_end, gap);
+    _pos = _end;
+
+    if (status == ChunkedDecoder::NEED_MORE)
+        return NEED_MORE;
+    _state = S_DONE;
+    return COMPLETE;
+}
+
+// ==================== MACCHINA A STATI ====================
+
+RequestParser::Status RequestParser::feed(std::string& buffer) {
+    if (_state == S_DONE)
+        return COMPLETE;
+    if (_state == S_ERROR)
+        return ERROR;
+
+    const size_t size = buffer.size();
+    int code;
+
+    while (_pos < size) {
+        if (_state < S_BODY && _pos - _begin >= MAX_HEADER_SIZE)
+            return fail(HTTP_BAD_REQUEST);
+
+        char c = buffer[_pos];
+        switch (_state) {
+
+        // ---------- Request line ----------
+        case S_METHOD:
+            if ((c == '\r' || c == '\n') && _pos == _mark) {
+                // Righe vuote prima della request line: ignorate (RFC 9112 2.2)
+                _mark = ++_pos;
+                continue;
+            }
+            if (c == ' ') {
+                if (_pos == _mark)
+                    return fail(HTTP_BAD_REQUEST);
+                _method.offset = _mark;
+                _method.length = _pos - _mark;
+                _mark = _pos + 1;
+                _state = S_TARGET;
+            } else if (!isTokenChar(c)) {
+                return fail(HTTP_BAD_REQUEST);
+            }
+            break;
+
+        case S_TARGET:
+            if (c == ' ') {
+                if (_pos == _mark)
+                    return fail(HTTP_BAD_REQUEST);
+                _target.offset = _mark;
+                _target.length = _pos - _mark;
+                _mark = _pos + 1;
+                _state = S_VERSION;
+            } else if (isControlChar(c) || c == '\t') {
+                return fail(HTTP_BAD_REQUEST);
+            }
+            break;
+
+        case S_VERSION:
+            if (c == '\r' || c == '\n') {
+                _version.offset = _mark;
+                _version.length = _pos - _mark;
+                _state = (c == '\r') ? S_REQUEST_LINE_LF : S_HEADER_START;
+            } else if (c == ' ' || isControlChar(c)) {
+                return fail(HTTP_BAD_REQUEST);
+            }
+            break;
+
+        case S_REQUEST_LINE_LF:
+            if (c != '\n')
+                return fail(HTTP_BAD_REQUEST);
+            _state = S_HEADER_START;
+            break;
+
+        // ---------- Header ----------
+        case S_HEADER_START:
+            if (c == '\r') {
+                _state = S_HEADERS_END_LF;
+                break;
+            }
+            if (c == '\n') {
+                ++_pos;
+                if ((code = headersComplete(buffer)) != 0)
+                    return fail(code);
+                if (_state == S_DONE)
+                    return COMPLETE;
+                continue;
+            }
+            // obs-fold non supportato (RFC 9112 5.2)
+            if (c == ' ' || c == '\t' || !isTokenChar(c))
+                return fail(HTTP_BAD_REQUEST);
+            _mark = _pos;
+            _state = S_HEADER_NAME;
+            break;
+
+        case S_HEADER_NAME:
+            if (c == ':') {
+                if (_pos == _mark)
+                    return fail(HTTP_BAD_REQUEST);
+                _headers.push_back(HeaderSpan());
+                _headers.back().name.offset = _mark;
+                _headers.back().name.length = _pos - _mark;
+                _state = S_HEADER_VALUE_START;
+            } else if (!isTokenChar(c)) {
+                return fail(HTTP_BAD_REQUEST);
+            }
+            break;
+
+        case S_HEADER_VALUE_START:
+            if (c == ' ' || c == '\t')
+                break;
+            _mark = _pos;
+            _value_end = _pos;
+            _state = S_HEADER_VALUE;
+            continue;
+
+        case S_HEADER_VALUE:
+            if (c == '\r' || c == '\n') {
+                _headers.back().value.offset = _mark;
+                _headers.back().value.length = _value_end - _mark;
+                if (c == '\r') {
+                    _state = S_HEADER_LF;
+                    break;
+                }
+                if ((code = headerDone(buffer)) != 0)
+                    return fail(code);
+                _state = S_HEADER_START;
+            } else if (isControlChar(c)) {
+                return fail(HTTP_BAD_REQUEST);
+            } else if (c != ' ' && c != '\t') {
+                _value_end = _pos + 1;
+            }
+            break;
+
+        case S_HEADER_LF:
+            if (c != '\n')
+                return fail(HTTP_BAD_REQUEST);
+            if ((code = headerDone(buffer)) != 0)
+                return fail(code);
+            _state = S_HEADER_START;
+            break;
+
+        case S_HEADERS_END_LF:
+            if (c != '\n')
+                return fail(HTTP_BAD_REQUEST);
+            ++_pos;
+            if ((code = headersComplete(buffer)) != 0)
+                return fail(code);
+            if (_state == S_DONE)
+                return COMPLETE;
+            continue;
+
+        // ---------- Body con Content-Length: nessuna scansione ----------
+        case S_BODY:
+            if (size - _body_offset >= _content_length) {
+                _pos = _end = _body_offset + _content_length;
+                _state = S_DONE;
+                return COMPLETE;
+            }
+            _pos = size;
+            continue;
+
+        // ---------- Body chunked: decodificato nel buffer ----------
+        case S_CHUNKED:
+            return decodeChunks(buffer);
+
+        case S_DONE:
+            return COMPLETE;
+        case S_ERROR:
+            return ERROR;
+        }
+        ++_pos;
+    }
+
+    // Richiesta senza body completata proprio sull'ultimo byte
+    if (_state == S_DONE)
+        return COMPLETE;
+    return NEED_MORE;
+}
@@ -12,84 +12,194 @@
 
 #include "../../../incs/webserv.hpp"
 
-
-#include "Response.hpp"             // Local header
-
-// Constructor, status code is 200 by default
-Response::Response() : status(200)
-{
-    // No print in constructor
+#include "../incs/Response.hpp"
+#include "../../Utils/incs/Clock.hpp"
+
+struct HeaderText {
+    const char* text;
+    size_t      length;
+};
+
+struct StatusEntry {
+    int         status;
+    const char* reason;
+    HeaderText  line;
+};
+
+#define LINE(text) { text, sizeof(text) - 1 }
+#define STATUS(code, phrase) { code, phrase, LINE(HTTP_VERSION " " #code " " phrase "\r\n") }
+
+static const StatusEntry STATUS_LINES[] = {
+    STATUS(200, "OK"),
+    STATUS(201, "Created"),
+    STATUS(204, "No Content"),
+    STATUS(301, "Moved Permanently"),
+    STATUS(302, "Found"),
+    STATUS(304, "Not Modified"),
+    STATUS(400, "Bad Request"),
+    STATUS(403, "Forbidden"),
+    STATUS(404, "Not Found"),
+    STATUS(405, "Method Not Allowed"),
+    STATUS(408, "Request Timeout"),
+    STATUS(411, "Length Required"),
+    STATUS(413, "Request Entity Too Large"),
+    STATUS(414, "URI Too Long"),
+    STATUS(415, "Unsupported Media Type"),
+    STATUS(500, "Internal Server Error"),
+    STATUS(501, "Not Implemented"),
+    STATUS(502, "Bad Gateway"),
+    STATUS(503, "Service Unavailable"),
+    STATUS(504, "Gateway Timeout"),
+    STATUS(505, "HTTP Version Not Supported")
+};
+
+// Stesso ordine di Response::HeaderLine
+static const HeaderText HEADER_LINES[Response::HEADER_LINE_COUNT] = {
+    LINE("Connection: keep-alive\r\n"),
+    LINE("Connection: close\r\n"),
+    LINE("Content-Type: text/html\r\n"),
+    LINE("Content-Type: text/plain\r\n"),
+    LINE("Content-Length: 0\r\n"),
+    LINE("Transfer-Encoding: chunked\r\n"),
+    LINE("Cache-Control: no-cache\r\n"),
+    LINE("Server: webserv/1.0\r\n"),
+    LINE("Access-Control-Allow-Origin: *\r\n"),
+    LINE("Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"),
+    LINE("Access-Control-Allow-Headers: Content-Type, Authorization\r\n"),
+    LINE("Access-Control-Allow-Headers: Content-Type, Content-Length\r\n")
+};
+
+#undef STATUS
+#undef LINE
+
+static const size_t STATUS_COUNT = sizeof(STATUS_LINES) / sizeof(STATUS_LINES[0]);
+
+static const StatusEntry* findStatus(int status) {
+    for (size_t i = 0; i < STATUS_COUNT; ++i)
+        if (STATUS_LINES[i].status == status)
+            return &STATUS_LINES[i];
+    return NULL;
 }
 
-
-// Destructor
-Response::~Response()
-{
-    // No print in destructor
+Response::Response(int status) : _length(0), _spill(), _body(), _closed(false) {
+    setStatus(status);
 }
 
+void Response::setStatus(int status) {
+    _length = 0;
+    _spill.clear();
+    _body.clear();
+    _closed = false;
 
+    const StatusEntry* known = findStatus(status);
+    if (known) {
+        append(known->line.text, known->line.length);
+        return;
+    }
+    // Status senza riga precalcolata (es. inoltrato da un backend)
+    append(HTTP_VERSION " ", sizeof(HTTP_VERSION " ") - 1);
+    appendNumber(static_cast<size_t>(status));
+    append(" Unknown\r\n", sizeof(" Unknown\r\n") - 1);
+}
 
+const char* Response::reason(int status) {
+    const StatusEntry* known = findStatus(status);
+    return known ? known->reason : "Unknown";
+}
 
-// Setters
+void Response::addLine(HeaderLine line) {
+    append(HEADER_LINES[line].text, HEADER_LINES[line].length);
+}
 
+void Response::addHeader(const char* name, const std::string& value) {
+    append(name, strlen(name));
+    append(": ", 2);
+    append(value.data(), value.size());
+    append("\r\n", 2);
+}
 
-// Set the response status code
-void Response::setStatus(int status)
-{
-    
-    this->status = status;  // Set the status code
-    
+void Response::addHeader(const char* name, size_t value) {
+    append(name, strlen(name));
+    append(": ", 2);
+    appendNumber(value);
+    append("\r\n", 2);
 }
 
+void Response::addConnection(bool keep_alive, unsigned long timeout_seconds) {
+    if (!keep_alive) {
+        addLine(CONNECTION_CLOSE);
+        return;
+    }
+    addLine(CONNECTION_KEEP_ALIVE);
+    if (timeout_seconds == 0) {
+        append("Keep-Alive: max=100\r\n", sizeof("Keep-Alive: max=100\r\n") - 1);
+        return;
+    }
+    append("Keep-Alive: timeout=", sizeof("Keep-Alive: timeout=") - 1);
+    appendNumber(timeout_seconds);
+    append(", max=100\r\n", sizeof(", max=100\r\n") - 1);
+}
 
-// Set a response header
-void Response::setHeader(const std::string& key, const std::string& value)
-{
-    
-    _headers[key] = value;   // Set the header
-    
+void Response::addDate() {
+    append("Date: ", 6);
+    append(Clock::httpDate(), Clock::HTTP_DATE_LENGTH);
+    append("\r\n", 2);
 }
 
+size_t Response::writeTail(char* out, bool keep_alive) {
+    const HeaderText& connection = HEADER_LINES[keep_alive ? CONNECTION_KEEP_ALIVE : CONNECTION_CLOSE];
+    size_t length = 0;
+    memcpy(out, connection.text, connection.length);
+    length += connection.length;
+    memcpy(out + length, "Date: ", 6);
+    length += 6;
+    memcpy(out + length, Clock::httpDate(), Clock::HTTP_DATE_LENGTH);
+    length += Clock::HTTP_DATE_LENGTH;
+    memcpy(out + length, "\r\n\r\n", 4);
+    return length + 4;
+}
 
-// Set the response body
-void Response::setBody(const std::string& _body)
-{
-    
-    this->_body = _body;  // Set the body
-    
+void Response::addLines(const char* data, size_t length) {
+    append(data, length);
 }
 
+void Response::setBody(const std::string& body) {
+    addHeader("Content-Length", body.size());
+    _body = body;
+}
 
-// Generate the HTTP response
-std::string Response::generate() const
-{
-    
-    // Output stream
-    std::ostringstream oss;
-
-    // Status line
-    oss
-    << "HTTP/1.1 "
-    << status
-    << " OK\r\n";   // Status code and reason phrase
-
-    // Headers, including Content-Length and Connection headers
-    for (std::map<std::string, std::string>::const_iterator it = _headers.begin(); it != _headers.end(); ++it)
-    {
-        oss
-        << it->first
-        << ": "
-        << it->second
-        << "\r\n";  // Header key and value
+size_t Response::gather(struct iovec* iov) {
+    if (!_closed) {
+        append("\r\n", 2);
+        _closed = true;
     }
+    iov[0].iov_base = const_cast<char*>(headData());
+    iov[0].iov_len = headLength();
+    if (_body.empty())
+        return 1;
+    iov[1].iov_base = const_cast<char*>(_body.data());
+    iov[1].iov_len = _body.size();
+    return 2;
+}
 
-    // End of headers
-    oss << "\r\n";
-
-    // Body
-    oss << _body;
+void Response::append(const char* data, size_t length) {
+    if (_spill.empty() && _length + length <= HEAD_SIZE) {
+        memcpy(_head + _length, data, length);
+        _length += length;
+        return;
+    }
+    // Blocco header fuori misura: prosegue su una std::string
+    if (_spill.empty())
+        _spill.assign(_head, _length);
+    _spill.append(data, length);
+}
 
-    // Return the response as a string
-    return  (oss.str());
+void Response::appendNumber(size_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[sizeof(digits) - ++count] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    append(digits + sizeof(digits) - count, count);
 }
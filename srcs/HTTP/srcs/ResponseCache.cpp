@@ -0,0 +1,93 @@
+#include "../../../incs/webserv.hpp"
+
+#include "ResponseCache.hpp"
+
+ResponseCache::ResponseCache()
+    : _entries(), _lru(), _budget(0), _max_file(0), _used(0), _hits(0), _misses(0) {}
+
+ResponseCache::~ResponseCache() {
+    clear();
+}
+
+void ResponseCache::configure(size_t budget, size_t max_file) {
+    clear();
+    _budget = budget;
+    _max_file = max_file;
+}
+
+bool ResponseCache::isCacheable(const OpenFileInfo& file) const {
+    return _budget > 0 && file.error == 0 && !file.is_dir
+        && static_cast<size_t>(file.size) <= _max_file
+        && static_cast<size_t>(file.size) <= _budget;
+}
+
+const CachedResponse* ResponseCache::find(const std::string& path, const OpenFileInfo& file) {
+    if (_budget == 0)
+        return NULL;
+    EntryMap::iterator it = _entries.find(path);
+    if (it != _entries.end()) {
+        CachedResponse& entry = it->second;
+        if (entry.ino == file.ino && entry.dev == file.dev
+            && entry.mtime == file.mtime && entry.size == file.size) {
+            ++_hits;
+            _lru.splice(_lru.begin(), _lru, entry.lru);
+            return &entry;
+        }
+        // File modificato su disco: la copia in memoria non vale più
+        drop(it);
+    }
+    ++_misses;
+    return NULL;
+}
+
+const CachedResponse* ResponseCache::insert(const std::string& path, const OpenFileInfo& file,
+                                            const std::string& head, std::string& body) {
+    size_t bytes = path.size() + head.size() + body.size();
+    if (bytes > _budget)
+        return NULL;
+
+    drop(_entries.find(path));
+    while (!_lru.empty() && _used + bytes > _budget)
+        drop(_entries.find(_lru.back()));
+
+    _lru.push_front(path);
+    CachedResponse& entry = _entries[path];
+    entry.head = new SharedBuffer();
+    entry.head->data = head;
+    entry.body = new SharedBuffer();
+    entry.body->data.swap(body);
+    entry.mtime = file.mtime;
+    entry.size = file.size;
+    entry.ino = file.ino;
+    entry.dev = file.dev;
+    entry.bytes = bytes;
+    entry.lru = _lru.begin();
+    _used += bytes;
+    return &entry;
+}
+
+void ResponseCache::drop(EntryMap::iterator it) {
+    if (it == _entries.end())
+        return;
+    // I buffer restano vivi finché le code che li stanno inviando non li rilasciano
+    SharedBuffer::release(it->second.head);
+    SharedBuffer::release(it->second.body);
+    _used -= it->second.bytes;
+    _lru.erase(it->second.lru);
+    _entries.erase(it);
+}
+
+void ResponseCache::invalidate(const std::string& path) {
+    drop(_entries.find(path));
+    std::string prefix = path;
+    if (prefix.empty() || prefix[prefix.size() - 1] != '/')
+        prefix += '/';
+    EntryMap::iterator it = _entries.lower_bound(prefix);
+    while (it != _entries.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+        drop(it++);
+}
+
+void ResponseCache::clear() {
+    while (!_entries.empty())
+        drop(_entries.begin());
+}
@@ -0,0 +1,88 @@
+/**
+ * @file Arena.hpp
+ * @brief Allocatore a puntatore crescente per i dati di una singola richiesta
+ *
+ * Parser, routing e costruzione della risposta producono molti piccoli
+ * oggetti che vivono esattamente quanto la richiesta. Invece di una
+ * new/delete ciascuno li prende in sequenza da blocchi dell'arena e
+ * vengono liberati tutti insieme da reset() quando la richiesta finisce.
+ *
+ * I blocchi arrivano dal BufferPool dei buffer di lettura e tornano lì a
+ * ogni reset(): una connessione inattiva non ne tiene nessuno, e in
+ * regime l'arena non chiama mai l'allocatore globale. Le richieste più
+ * grandi di un blocco ricevono un blocco dedicato, liberato al reset().
+ *
+ * Compilando con ALLOC_STATS=1 (WEBSERV_ALLOC_STATS) il server conta
+ * anche le allocazioni sull'heap globale e stampa, per ogni richiesta,
+ * i byte presi dall'arena e le allocazioni fatte fuori dall'arena.
+ */
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "../../../incs/webserv.hpp"
+
+#include "BufferPool.hpp"
+
+class Arena {
+public:
+    /** @brief Allineamento di ogni allocazione */
+    static const size_t ALIGN = 16;
+
+    Arena();
+
+    /** @brief Restituisce i blocchi ancora presi */
+    ~Arena();
+
+    /** @brief Pool da cui prendere i blocchi (NULL: new/delete) */
+    void setPool(BufferPool* pool) { _pool = pool; }
+
+    /** @brief size byte allineati, validi fino al prossimo reset() */
+    void* allocate(size_t size);
+
+    /** @brief Copia di length byte seguita da '\\0' */
+    char* copy(const char* data, size_t length);
+
+    /** @brief Libera in un colpo tutto ciò che è stato allocato */
+    void reset();
+
+    /** @brief Byte allocati dall'ultimo reset() */
+    size_t bytes() const { return _bytes; }
+
+    /** @brief Allocazioni dall'ultimo reset() */
+    size_t allocations() const { return _allocations; }
+
+private:
+    /** @brief Intestazione di ogni blocco: lista dei blocchi presi */
+    struct Block {
+        Block*  next;
+        bool    large;      ///< Blocco dedicato, non appartiene al pool
+    };
+
+    static const size_t HEADER = (sizeof(Block) + ALIGN - 1) & ~(ALIGN - 1);
+
+    BufferPool* _pool;
+    Block*      _blocks;
+    char*       _cursor;
+    char*       _end;
+    size_t      _bytes;
+    size_t      _allocations;
+
+    // Possiede i blocchi: non copiabile
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    char* grow(size_t size);
+};
+
+#ifdef WEBSERV_ALLOC_STATS
+/**
+ * @brief Contatori dell'heap globale (operator new sostituito in Arena.cpp)
+ */
+struct HeapStats {
+    static size_t allocations;
+    static size_t bytes;
+};
+#endif
+
+#endif // ARENA_HPP
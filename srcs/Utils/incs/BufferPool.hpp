@@ -0,0 +1,57 @@
+/**
+ * @file BufferPool.hpp
+ * @brief Blocchi di memoria di dimensione fissa riusati per le letture dai socket
+ *
+ * Ogni lettura da un client ha bisogno di un buffer per un solo recv():
+ * invece di allocarlo (e azzerarlo) a ogni evento, lo prende da una
+ * lista di blocchi liberi e lo restituisce subito dopo. I blocchi
+ * restituiti oltre max_idle vengono liberati, così un picco di letture
+ * non resta come memoria occupata.
+ *
+ * I contatori distinguono i blocchi allocati davvero dalle richieste
+ * servite dalla lista: in regime le allocazioni restano ferme.
+ */
+
+#ifndef BUFFERPOOL_HPP
+#define BUFFERPOOL_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class BufferPool {
+public:
+    /** @brief Dimensione di ogni blocco (un recv() dal client) */
+    static const size_t SLAB_SIZE = 16384;
+
+    /** @param max_idle Blocchi liberi conservati per il riuso */
+    explicit BufferPool(size_t max_idle = 64);
+
+    /** @brief Libera i blocchi nella lista (quelli in uso devono essere già tornati) */
+    ~BufferPool();
+
+    /** @brief Blocco da SLAB_SIZE byte, dalla lista se possibile */
+    char* acquire();
+
+    /** @brief Restituisce un blocco ottenuto da acquire() */
+    void release(char* slab);
+
+    /** @brief Libera i blocchi nella lista */
+    void clear();
+
+    size_t allocations() const { return _allocations; }    ///< Blocchi allocati con new
+    size_t acquisitions() const { return _acquisitions; }  ///< Chiamate ad acquire()
+    size_t inUse() const { return _in_use; }
+    size_t idle() const { return _free.size(); }
+
+private:
+    std::vector<char*>  _free;
+    size_t              _max_idle;
+    size_t              _allocations;
+    size_t              _acquisitions;
+    size_t              _in_use;
+
+    // Possiede i blocchi: non copiabile
+    BufferPool(const BufferPool&);
+    BufferPool& operator=(const BufferPool&);
+};
+
+#endif // BUFFERPOOL_HPP
@@ -0,0 +1,61 @@
+/**
+ * @file Clock.hpp
+ * @brief Orologio del processo letto una volta per iterazione del loop
+ *
+ * Il loop degli eventi chiama update() al risveglio da poll()/epoll_wait():
+ * da lì in poi timeout, cache e risposte usano lo stesso istante, senza
+ * una time() o una clock_gettime() per ogni richiesta. La risoluzione
+ * è quella di un'iterazione, più che sufficiente per scadenze espresse
+ * in secondi o in tick da 100 ms.
+ *
+ * La data HTTP (IMF-fixdate, RFC 7231 §7.1.1.1) viene riformattata solo
+ * quando cambia il secondo: nelle risposte costa la copia di 29 byte.
+ */
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include "../../../incs/webserv.hpp"
+
+class Clock {
+public:
+    /** @brief Lunghezza di "Sun, 06 Nov 1994 08:49:37 GMT" */
+    static const size_t HTTP_DATE_LENGTH = 29;
+
+    /** @brief Rilegge l'ora di sistema (una volta per iterazione del loop) */
+    static void update();
+
+    /** @brief Secondi dall'epoch all'ultimo update() */
+    static time_t now();
+
+    /** @brief Millisecondi monotoni all'ultimo update() (non seguono le modifiche dell'ora di sistema) */
+    static unsigned long milliseconds();
+
+    /** @brief Data HTTP dell'ultimo update(), terminata da NUL */
+    static const char* httpDate();
+
+    /**
+     * @brief Formatta un istante come data HTTP (IMF-fixdate)
+     * @param out Almeno HTTP_DATE_LENGTH + 1 byte, terminato da NUL
+     */
+    static void formatHttpDate(time_t when, char* out);
+
+    /**
+     * @brief Legge una data HTTP in formato IMF-fixdate
+     * @return false se il valore non è una IMF-fixdate valida
+     *
+     * I formati obsoleti (RFC 850, asctime) non sono riconosciuti: chi
+     * li usa in If-Modified-Since riceve la risposta completa.
+     */
+    static bool parseHttpDate(const std::string& value, time_t& when);
+
+private:
+    static time_t           _now;
+    static unsigned long    _milliseconds;
+    static time_t           _formatted;     ///< Secondo a cui si riferisce _date
+    static char             _date[HTTP_DATE_LENGTH + 1];
+
+    Clock();
+};
+
+#endif // CLOCK_HPP
@@ -26,6 +26,7 @@ public:
     static bool deleteFile(const std::string& path);
     static bool deleteDirectory(const std::string& path);
     static std::string sanitizePath(const std::string& path);
+    static void sanitizePathInPlace(std::string& path);
 
     static std::string normalizePath(const std::string& path) {
         std::string result;
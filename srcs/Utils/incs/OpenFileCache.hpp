@@ -0,0 +1,109 @@
+/**
+ * @file OpenFileCache.hpp
+ * @brief Cache di descrittori aperti e metadati dei file statici
+ *
+ * Equivalente di open_file_cache di nginx: per ogni percorso risolto
+ * conserva fd, dimensione, mtime, inode, tipo MIME e validatori HTTP
+ * (ETag, Last-Modified), oppure l'errno
+ * dell'ultima apertura fallita (entry negative per i 404). Entro il
+ * periodo di validità una GET su un file già visto non esegue né
+ * stat() né open(); scaduto il periodo basta una stat() per confermare
+ * che il file non è cambiato.
+ *
+ * I descrittori sono condivisi tra richieste con un contatore di
+ * riferimenti: sendfile() usa un offset esplicito, quindi più
+ * trasferimenti possono leggere lo stesso fd contemporaneamente.
+ */
+
+#ifndef OPENFILECACHE_HPP
+#define OPENFILECACHE_HPP
+
+#include "../../../incs/webserv.hpp"
+
+/**
+ * @brief Metadati di un percorso come visti dalla cache
+ */
+struct OpenFileInfo {
+    int         error;      ///< 0 se il percorso esiste, altrimenti errno
+    bool        is_dir;
+    int         fd;         ///< Aperto solo per file regolari, altrimenti -1
+    off_t       size;
+    time_t      mtime;
+    ino_t       ino;
+    dev_t       dev;
+    std::string mime;
+    std::string etag;           ///< ETag forte da inode, dimensione e mtime (virgolette comprese)
+    std::string last_modified;  ///< mtime come data HTTP
+
+    OpenFileInfo() : error(0), is_dir(false), fd(-1), size(0), mtime(0), ino(0), dev(0),
+                     mime(), etag(), last_modified() {}
+};
+
+class OpenFileCache {
+public:
+    OpenFileCache();
+    ~OpenFileCache();
+
+    /**
+     * @brief Imposta capacità e validità
+     * @param max_entries Numero massimo di percorsi (0 = cache disattivata)
+     * @param valid_seconds Secondi prima di riverificare un'entry con stat()
+     *
+     * Con la cache disattivata resta un solo percorso, riverificato ad
+     * ogni lookup: il costo è una stat() invece di stat + open + fstat.
+     */
+    void configure(size_t max_entries, time_t valid_seconds);
+
+    /**
+     * @brief Restituisce i metadati di un percorso, aprendolo se necessario
+     * @return Riferimento valido fino al prossimo lookup(), invalidate() o clear()
+     */
+    const OpenFileInfo& lookup(const std::string& path);
+
+    /**
+     * @brief Prende un riferimento sul descrittore di un file in cache
+     * @return fd da restituire con release() a trasferimento concluso
+     */
+    int acquire(const OpenFileInfo& info);
+
+    /** @brief Rilascia un riferimento; l'fd viene chiuso con l'ultimo */
+    void release(int fd);
+
+    /** @brief Rimuove un percorso e, se è una directory, i percorsi al suo interno (dopo upload o DELETE) */
+    void invalidate(const std::string& path);
+
+    /** @brief Rimuove tutte le entry (i trasferimenti in corso restano validi) */
+    void clear();
+
+    // ==================== STATISTICHE ====================
+
+    size_t hits() const { return _hits; }
+    size_t misses() const { return _misses; }
+    size_t size() const { return _entries.size(); }
+    size_t openDescriptors() const { return _refs.size(); }
+
+private:
+    struct Entry {
+        OpenFileInfo                     info;
+        time_t                           validated;
+        std::list<std::string>::iterator lru;
+    };
+    typedef std::map<std::string, Entry> EntryMap;
+
+    EntryMap                _entries;
+    std::list<std::string>  _lru;       ///< In testa il percorso usato più di recente
+    std::map<int, size_t>   _refs;      ///< fd -> riferimenti (entry + trasferimenti)
+    size_t                  _max_entries;
+    time_t                  _valid;
+    size_t                  _hits;
+    size_t                  _misses;
+
+    void load(const std::string& path, OpenFileInfo& info);
+    static void setValidators(OpenFileInfo& info);
+    void drop(EntryMap::iterator it);
+
+    OpenFileCache(const OpenFileCache&);
+    OpenFileCache& operator=(const OpenFileCache&);
+};
+
+#endif // OPENFILECACHE_HPP
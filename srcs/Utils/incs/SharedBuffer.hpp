@@ -0,0 +1,38 @@
+/**
+ * @file SharedBuffer.hpp
+ * @brief Buffer immutabile condiviso con contatore di riferimenti
+ *
+ * Usato dalla cache delle risposte: la stessa copia in memoria di
+ * header e body viene accodata su più connessioni senza essere
+ * copiata, e sopravvive all'eviction finché l'ultimo invio non termina.
+ */
+
+#ifndef SHAREDBUFFER_HPP
+#define SHAREDBUFFER_HPP
+
+#include "../../../incs/webserv.hpp"
+
+struct SharedBuffer {
+    std::string data;
+    size_t      refs;
+
+    SharedBuffer() : data(), refs(1) {}
+
+    /** @brief Prende un riferimento in più */
+    static SharedBuffer* retain(SharedBuffer* buffer) {
+        ++buffer->refs;
+        return buffer;
+    }
+
+    /** @brief Rilascia un riferimento; il buffer viene liberato con l'ultimo */
+    static void release(SharedBuffer* buffer) {
+        if (buffer && --buffer->refs == 0)
+            delete buffer;
+    }
+
+private:
+    SharedBuffer(const SharedBuffer&);
+    SharedBuffer& operator=(const SharedBuffer&);
+};
+
+#endif // SHAREDBUFFER_HPP
@@ -46,6 +46,20 @@ static std::string urlDecode(const std::string &str) {
         return decoded.str();
     }
 
+    // Blocco di body per Transfer-Encoding: chunked ("" per dati vuoti,
+    // che chiuderebbero il body: il chunk finale è HTTP_LAST_CHUNK)
+    static std::string chunkEncode(const std::string& data) {
+        if (data.empty())
+            return "";
+        std::ostringstream size;
+        size << std::hex << data.size() << "\r\n";
+        std::string chunk = size.str();
+        chunk.reserve(chunk.size() + data.size() + 2);
+        chunk += data;
+        chunk += "\r\n";
+        return chunk;
+    }
+
 };
 
 #endif // STRINGUTILS_HPP
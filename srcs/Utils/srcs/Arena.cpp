@@ -0,0 +1,99 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/Arena.hpp"
+
+Arena::Arena() : _pool(NULL), _blocks(NULL), _cursor(NULL), _end(NULL), _bytes(0), _allocations(0) {}
+
+Arena::~Arena() {
+    reset();
+}
+
+void* Arena::allocate(size_t size) {
+    size = (size + ALIGN - 1) & ~(ALIGN - 1);
+    ++_allocations;
+    _bytes += size;
+    if (static_cast<size_t>(_end - _cursor) < size)
+        return grow(size);
+    char* memory = _cursor;
+    _cursor += size;
+    return memory;
+}
+
+char* Arena::copy(const char* data, size_t length) {
+    char* memory = static_cast<char*>(allocate(length + 1));
+    memcpy(memory, data, length);
+    memory[length] = '\0';
+    return memory;
+}
+
+/**
+ * @brief Prende un blocco nuovo e ci alloca size byte
+ *
+ * Il resto del blocco corrente viene abbandonato fino al reset().
+ */
+char* Arena::grow(size_t size) {
+    char* memory;
+    bool large = HEADER + size > BufferPool::SLAB_SIZE;
+    if (large)
+        memory = new char[HEADER + size];
+    else if (_pool)
+        memory = _pool->acquire();
+    else
+        memory = new char[BufferPool::SLAB_SIZE];
+
+    Block* block = reinterpret_cast<Block*>(memory);
+    block->next = _blocks;
+    block->large = large;
+    _blocks = block;
+
+    // Un blocco dedicato non diventa il blocco corrente
+    if (large)
+        return memory + HEADER;
+    _cursor = memory + HEADER + size;
+    _end = memory + BufferPool::SLAB_SIZE;
+    return memory + HEADER;
+}
+
+void Arena::reset() {
+    while (_blocks) {
+        Block* next = _blocks->next;
+        char* memory = reinterpret_cast<char*>(_blocks);
+        if (_blocks->large || !_pool)
+            delete[] memory;
+        else
+            _pool->release(memory);
+        _blocks = next;
+    }
+    _cursor = NULL;
+    _end = NULL;
+    _bytes = 0;
+    _allocations = 0;
+}
+
+#ifdef WEBSERV_ALLOC_STATS
+// Sostituzione dell'allocatore globale: conta ogni new, anche quelle
+// fatte dalla libreria standard per std::string, std::map e simili
+size_t HeapStats::allocations = 0;
+size_t HeapStats::bytes = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    ++HeapStats::allocations;
+    HeapStats::bytes += size;
+    void* memory = malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) throw() {
+    free(memory);
+}
+
+void operator delete[](void* memory) throw() {
+    free(memory);
+}
+#endif
@@ -0,0 +1,38 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/BufferPool.hpp"
+
+BufferPool::BufferPool(size_t max_idle) :
+    _free(), _max_idle(max_idle), _allocations(0), _acquisitions(0), _in_use(0) {}
+
+BufferPool::~BufferPool() {
+    clear();
+}
+
+char* BufferPool::acquire() {
+    ++_acquisitions;
+    ++_in_use;
+    if (_free.empty()) {
+        ++_allocations;
+        return new char[SLAB_SIZE];
+    }
+    char* slab = _free.back();
+    _free.pop_back();
+    return slab;
+}
+
+void BufferPool::release(char* slab) {
+    if (!slab)
+        return;
+    --_in_use;
+    if (_free.size() < _max_idle)
+        _free.push_back(slab);
+    else
+        delete[] slab;
+}
+
+void BufferPool::clear() {
+    for (size_t i = 0; i < _free.size(); ++i)
+        delete[] _free[i];
+    _free.clear();
+}
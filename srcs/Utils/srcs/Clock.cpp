@@ -0,0 +1,110 @@
+#include "../../../incs/webserv.hpp"
+
+#include "../incs/Clock.hpp"
+
+time_t          Clock::_now = 0;
+unsigned long   Clock::_milliseconds = 0;
+time_t          Clock::_formatted = -1;
+char            Clock::_date[Clock::HTTP_DATE_LENGTH + 1];
+
+void Clock::update() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    _milliseconds = static_cast<unsigned long>(ts.tv_sec) * 1000 + static_cast<unsigned long>(ts.tv_nsec / 1000000);
+    _now = time(NULL);
+}
+
+// Prima del primo update() (oggetti statici, avvio) legge l'ora al volo
+time_t Clock::now() {
+    if (_milliseconds == 0)
+        update();
+    return _now;
+}
+
+unsigned long Clock::milliseconds() {
+    if (_milliseconds == 0)
+        update();
+    return _milliseconds;
+}
+
+static const char DAYS[] = "SunMonTueWedThuFriSat";
+static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+const char* Clock::httpDate() {
+    if (_formatted != now()) {
+        formatHttpDate(_now, _date);
+        _formatted = _now;
+    }
+    return _date;
+}
+
+/**
+ * @brief Sempre in GMT e con nomi inglesi
+ *
+ * Niente strftime(): il risultato non deve dipendere dal locale.
+ */
+void Clock::formatHttpDate(time_t when, char* out) {
+    struct tm tm;
+    gmtime_r(&when, &tm);
+    memcpy(out, DAYS + tm.tm_wday * 3, 3);
+    out[3] = ',';
+    out[4] = ' ';
+    out[5] = static_cast<char>('0' + tm.tm_mday / 10);
+    out[6] = static_cast<char>('0' + tm.tm_mday % 10);
+    out[7] = ' ';
+    memcpy(out + 8, MONTHS + tm.tm_mon * 3, 3);
+    out[11] = ' ';
+    int year = tm.tm_year + 1900;
+    out[12] = static_cast<char>('0' + year / 1000 % 10);
+    out[13] = static_cast<char>('0' + year / 100 % 10);
+    out[14] = static_cast<char>('0' + year / 10 % 10);
+    out[15] = static_cast<char>('0' + year % 10);
+    out[16] = ' ';
+    out[17] = static_cast<char>('0' + tm.tm_hour / 10);
+    out[18] = static_cast<char>('0' + tm.tm_hour % 10);
+    out[19] = ':';
+    out[20] = static_cast<char>('0' + tm.tm_min / 10);
+    out[21] = static_cast<char>('0' + tm.tm_min % 10);
+    out[22] = ':';
+    out[23] = static_cast<char>('0' + tm.tm_sec / 10);
+    out[24] = static_cast<char>('0' + tm.tm_sec % 10);
+    memcpy(out + 25, " GMT", 4);
+    out[HTTP_DATE_LENGTH] = '\0';
+}
+
+// Valore di due o quattro cifre decimali in value[at..at+count), -1 se non sono cifre
+static int readDigits(const std::string& value, size_t at, size_t count) {
+    int result = 0;
+    for (size_t i = at; i < at + count; ++i) {
+        if (!isdigit(static_cast<unsigned char>(value[i])))
+            return -1;
+        result = result * 10 + (value[i] - '0');
+    }
+    return result;
+}
+
+bool Clock::parseHttpDate(const std::string& value, time_t& when) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT": ogni campo ha posizione fissa
+    if (value.size() != HTTP_DATE_LENGTH || value.compare(3, 2, ", ") != 0
+        || value[7] != ' ' || value[11] != ' ' || value[16] != ' '
+        || value[19] != ':' || value[22] != ':' || value.compare(25, 4, " GMT") != 0)
+        return false;
+
+    const char* month = strstr(MONTHS, value.substr(8, 3).c_str());
+    if (!month || (month - MONTHS) % 3 != 0)
+        return false;
+
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_mday = readDigits(value, 5, 2);
+    tm.tm_mon = static_cast<int>((month - MONTHS) / 3);
+    tm.tm_year = readDigits(value, 12, 4) - 1900;
+    tm.tm_hour = readDigits(value, 17, 2);
+    tm.tm_min = readDigits(value, 20, 2);
+    tm.tm_sec = readDigits(value, 23, 2);
+    if (tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_year < 70 || tm.tm_hour < 0 || tm.tm_hour > 23
+        || tm.tm_min < 0 || tm.tm_min > 59 || tm.tm_sec < 0 || tm.tm_sec > 60)
+        return false;
+    when = timegm(&tm);
+    return when != -1;
+}
@@ -132,9 +132,16 @@ bool FileHandler::deleteDirectory(const std::string& path) {
 }
 
 std::string FileHandler::sanitizePath(const std::string& path) {
-    std::string clean_path;
+    std::string clean_path(path);
+    sanitizePathInPlace(clean_path);
+    return clean_path;
+}
+
+// Stesse regole di sanitizePath(), compattando la stringa senza copiarla
+void FileHandler::sanitizePathInPlace(std::string& path) {
     bool last_was_slash = false;
     const size_t len = path.length();
+    size_t out = 0;
     
     for (size_t i = 0; i < len; ++i) {
         char c = path[i];
@@ -149,10 +156,9 @@ std::string FileHandler::sanitizePath(const std::string& path) {
         if (c == '/' && last_was_slash) continue;
         
         last_was_slash = (c == '/');
-        clean_path += c;
+        path[out++] = c;
     }
-    
-    return clean_path;
+    path.resize(out);
 }
 
 bool FileHandler::writeBinaryFile(const std::string& path, const std::string& content) {
@@ -37,10 +37,10 @@ bool FileOperation::openFile() {
 
     switch (type) {
         case FILE_OP_READ:
-            flags = O_RDONLY;
+            flags = O_RDONLY | O_CLOEXEC;
             break;
         case FILE_OP_WRITE:
-            flags = O_WRONLY | O_CREAT | O_TRUNC;
+            flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
             break;
         case FILE_OP_DELETE:
             return true;
@@ -0,0 +1,184 @@
+#include "../../../incs/webserv.hpp"
+
+#include "OpenFileCache.hpp"
+#include "MimeTypes.hpp"
+#include "Clock.hpp"
+
+OpenFileCache::OpenFileCache()
+    : _entries(), _lru(), _refs(), _max_entries(0), _valid(0), _hits(0), _misses(0) {}
+
+OpenFileCache::~OpenFileCache() {
+    clear();
+}
+
+void OpenFileCache::configure(size_t max_entries, time_t valid_seconds) {
+    _max_entries = max_entries;
+    _valid = (max_entries == 0) ? 0 : valid_seconds;
+    clear();
+}
+
+// ==================== LOOKUP ====================
+
+const OpenFileInfo& OpenFileCache::lookup(const std::string& path) {
+    time_t now = Clock::now();
+    EntryMap::iterator it = _entries.find(path);
+
+    if (it != _entries.end()) {
+        Entry& entry = it->second;
+        bool fresh = (now - entry.validated < _valid);
+
+        if (!fresh) {
+            // Scaduta: una stat() basta a capire se l'fd aperto è ancora buono
+            struct stat st;
+            int error = (stat(path.c_str(), &st) == 0) ? 0 : errno;
+            if (error == 0 && entry.info.error == 0) {
+                fresh = st.st_ino == entry.info.ino && st.st_dev == entry.info.dev
+                     && st.st_mtime == entry.info.mtime && st.st_size == entry.info.size
+                     && S_ISDIR(st.st_mode) == entry.info.is_dir;
+            } else {
+                fresh = (error != 0 && error == entry.info.error);
+            }
+            if (fresh)
+                entry.validated = now;
+        }
+
+        if (fresh) {
+            ++_hits;
+            _lru.splice(_lru.begin(), _lru, entry.lru);
+            return entry.info;
+        }
+        drop(it);
+    }
+
+    ++_misses;
+
+    // Con la cache disattivata resta comunque l'ultimo percorso visto
+    size_t capacity = (_max_entries > 0) ? _max_entries : 1;
+    while (!_entries.empty() && _entries.size() >= capacity)
+        drop(_entries.find(_lru.back()));
+
+    _lru.push_front(path);
+    Entry& entry = _entries[path];
+    entry.validated = now;
+    entry.lru = _lru.begin();
+    load(path, entry.info);
+    return entry.info;
+}
+
+void OpenFileCache::load(const std::string& path, OpenFileInfo& info) {
+    info = OpenFileInfo();
+
+    // O_NONBLOCK: l'open() di una FIFO non deve bloccare il loop;
+    // O_CLOEXEC: il descrittore non deve finire nei processi CGI
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1) {
+        info.error = errno;
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        info.error = errno;
+        close(fd);
+        return;
+    }
+
+    info.size = st.st_size;
+    info.mtime = st.st_mtime;
+    info.ino = st.st_ino;
+    info.dev = st.st_dev;
+
+    if (S_ISDIR(st.st_mode)) {
+        info.is_dir = true;
+        close(fd);
+        return;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        // FIFO, device, socket: mai serviti come file statici
+        info.error = EACCES;
+        close(fd);
+        return;
+    }
+
+    info.fd = fd;
+    info.mime = MimeTypes::getType(path);
+    setValidators(info);
+    _refs[fd] = 1;  // riferimento dell'entry stessa
+}
+
+static void appendHex(std::string& out, unsigned long value) {
+    static const char digits[] = "0123456789abcdef";
+    char buffer[sizeof(value) * 2];
+    size_t count = 0;
+    do {
+        buffer[sizeof(buffer) - ++count] = digits[value & 0xf];
+        value >>= 4;
+    } while (value > 0);
+    out.append(buffer + sizeof(buffer) - count, count);
+}
+
+/**
+ * @brief Calcola ETag e Last-Modified dai dati della fstat()
+ *
+ * Formato dell'ETag: "inode-dimensione-mtime" in esadecimale. Cambia
+ * se il file viene sostituito (inode), riscritto (mtime) o troncato.
+ * Calcolati una volta per apertura: le richieste li copiano soltanto.
+ */
+void OpenFileCache::setValidators(OpenFileInfo& info) {
+    info.etag = "\"";
+    appendHex(info.etag, static_cast<unsigned long>(info.ino));
+    info.etag += '-';
+    appendHex(info.etag, static_cast<unsigned long>(info.size));
+    info.etag += '-';
+    appendHex(info.etag, static_cast<unsigned long>(info.mtime));
+    info.etag += '"';
+
+    char date[Clock::HTTP_DATE_LENGTH + 1];
+    Clock::formatHttpDate(info.mtime, date);
+    info.last_modified.assign(date, Clock::HTTP_DATE_LENGTH);
+}
+
+// ==================== RIFERIMENTI ====================
+
+int OpenFileCache::acquire(const OpenFileInfo& info) {
+    if (info.fd != -1)
+        ++_refs[info.fd];
+    return info.fd;
+}
+
+void OpenFileCache::release(int fd) {
+    std::map<int, size_t>::iterator it = _refs.find(fd);
+    if (it == _refs.end())
+        return;
+    if (--it->second == 0) {
+        close(fd);
+        _refs.erase(it);
+    }
+}
+
+// ==================== INVALIDAZIONE ====================
+
+void OpenFileCache::drop(EntryMap::iterator it) {
+    if (it == _entries.end())
+        return;
+    if (it->second.info.fd != -1)
+        release(it->second.info.fd);
+    _lru.erase(it->second.lru);
+    _entries.erase(it);
+}
+
+void OpenFileCache::invalidate(const std::string& path) {
+    drop(_entries.find(path));
+    // Directory cancellata: anche le entry dei file che conteneva
+    std::string prefix = path;
+    if (prefix.empty() || prefix[prefix.size() - 1] != '/')
+        prefix += '/';
+    EntryMap::iterator it = _entries.lower_bound(prefix);
+    while (it != _entries.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+        drop(it++);
+}
+
+void OpenFileCache::clear() {
+    while (!_entries.empty())
+        drop(_entries.begin());
+}
@@ -48,6 +48,10 @@ int main(int argc, char **argv) {
     }
     else
     {
+        // Un client che chiude la connessione durante una scrittura non deve
+        // terminare il processo: gli errori vengono gestiti dal valore di ritorno
+        signal(SIGPIPE, SIG_IGN);
+
         try
         {
             // Fase 1: Caricamento della configurazione
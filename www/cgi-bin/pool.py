@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Example script for cgi_pool.
+
+Run as a normal CGI it handles one request and exits. Started by the
+pool (WEBSERV_CGI_POOL=1) it stays alive and serves one request per
+frame on stdin until EOF:
+
+    request:  [u32 length][NAME=value\\0 ...] [u32 length][body]
+    response: [u32 length][CGI output] ... [u32 0]
+"""
+
+import os
+import struct
+import sys
+
+
+def handle(env, body):
+    """Build the CGI output (headers, blank line, body) for one request."""
+    text = (
+        "<!DOCTYPE html>\n<html><body>\n"
+        "<h1>cgi_pool</h1>\n"
+        f"<p>Worker PID: {os.getpid()}</p>\n"
+        f"<p>Method: {env.get('REQUEST_METHOD', '')}</p>\n"
+        f"<p>Query string: {env.get('QUERY_STRING', '')}</p>\n"
+        f"<p>Body bytes: {len(body)}</p>\n"
+        "</body></html>\n"
+    )
+    return ("Content-Type: text/html\r\n\r\n" + text).encode()
+
+
+def read_exact(stream, size):
+    data = b""
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def read_block(stream):
+    header = read_exact(stream, 4)
+    if header is None:
+        return None
+    return read_exact(stream, struct.unpack(">I", header)[0])
+
+
+def serve():
+    stdin = sys.stdin.buffer
+    stdout = sys.stdout.buffer
+    while True:
+        block = read_block(stdin)
+        if block is None:
+            return
+        body = read_block(stdin)
+        if body is None:
+            return
+        env = dict(item.split("=", 1) for item in block.decode("latin-1").split("\0") if "=" in item)
+        output = handle(env, body)
+        stdout.write(struct.pack(">I", len(output)) + output + struct.pack(">I", 0))
+        stdout.flush()
+
+
+if __name__ == "__main__":
+    if os.environ.get("WEBSERV_CGI_POOL") == "1":
+        serve()
+    else:
+        length = int(os.environ.get("CONTENT_LENGTH") or 0)
+        body = sys.stdin.buffer.read(length) if length else b""
+        sys.stdout.buffer.write(handle(dict(os.environ), body))